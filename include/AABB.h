@@ -13,9 +13,23 @@ public:
     Point3 min() const;
     Point3 max() const;
 
-    bool hit(const Ray& r, double t_min, double t_max) const;
+    bool hit(const Ray& r, Real t_min, Real t_max) const;
     static AABB surrounding_box(const AABB& box0, const AABB& box1);
 
+    /**
+     * @brief «Пустая» коробка (min = +inf, max = -inf), нейтральная для объединения.
+     */
+    static AABB empty();
+
+    // расширить коробку точкой / другой коробкой
+    void expand(const Point3& p);
+    void expand(const AABB& other);
+
+    Point3 centroid() const;
+    Real   surface_area() const;
+    // ось (0=X,1=Y,2=Z) с наибольшей протяжённостью
+    int    longest_axis() const;
+
     Point3 minimum;
     Point3 maximum;
 };
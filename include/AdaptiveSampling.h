@@ -0,0 +1,64 @@
+// Адаптивная выборка: пиксель сэмплируется, пока относительная ошибка
+// оценки яркости не опустится ниже порога (в пределах [min_spp, max_spp]).
+#pragma once
+
+#include "Vec3.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief Параметры адаптивной выборки.
+ */
+struct AdaptiveSettings {
+    bool   enabled        = false;
+    int    min_spp        = 16;     // до этого числа проб ошибку не проверяем
+    int    max_spp        = 500;    // жёсткий предел проб на пиксель
+    int    check_interval = 8;      // проверять сходимость каждые N проб (меньше 1 — каждую)
+    double max_rel_error  = 0.02;   // порог относительной ошибки среднего
+    bool   write_heatmap  = false;  // сохранить карту spp рядом с изображением
+};
+
+/**
+ * @brief Яркость цвета (Rec. 709).
+ */
+inline double luminance(const Color& c) {
+    return 0.2126 * c.x + 0.7152 * c.y + 0.0722 * c.z;
+}
+
+/**
+ * @brief Скользящие среднее и дисперсия яркости пикселя (алгоритм Велфорда).
+ */
+struct PixelStats {
+    int    count = 0;
+    double mean  = 0.0;
+    double m2    = 0.0;   // сумма квадратов отклонений
+
+    void add(double x) {
+        ++count;
+        double delta = x - mean;
+        mean += delta / count;
+        m2   += delta * (x - mean);
+    }
+
+    double variance() const {
+        return count > 1 ? m2 / (count - 1) : 0.0;
+    }
+
+    /**
+     * @brief Стандартная ошибка среднего относительно самого среднего.
+     *
+     * Для почти чёрных пикселей знаменатель ограничен снизу, иначе
+     * они никогда не сойдутся.
+     */
+    double relative_error() const {
+        if (count < 2) return INFINITY;
+        double std_error = std::sqrt(variance() / count);
+        return std_error / std::fmax(mean, 1e-3);
+    }
+
+    bool converged(const AdaptiveSettings& s) const {
+        return count >= s.min_spp
+            && count % std::max(1, s.check_interval) == 0
+            && relative_error() < s.max_rel_error;
+    }
+};
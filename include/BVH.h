@@ -4,6 +4,44 @@
 #include "Hittable.h"
 #include <vector>
 
+// Параметры SAH (Surface Area Heuristic)
+constexpr int    SAH_BIN_COUNT      = 16;   // число корзин на ось
+constexpr Real   SAH_TRAVERSAL_COST = 1.0;  // стоимость обхода узла
+constexpr Real   SAH_INTERSECT_COST = 1.0;  // стоимость теста примитива
+
+/**
+ * @brief Сведения о примитиве для построения BVH: коробка и её центр.
+ */
+struct BVHPrimitiveInfo {
+    AABB   box;
+    Point3 centroid;
+};
+
+/**
+ * @brief Результат SAH-разбиения диапазона [start, end).
+ */
+struct SAHSplit {
+    int    axis = -1;   // ось разбиения; -1 — все центры совпадают
+    size_t mid  = 0;    // граница: [start, mid) и [mid, end)
+    Real   cost = 0.0;  // стоимость разбиения относительно площади родителя
+};
+
+/**
+ * @brief Разбить диапазон индексов по SAH с корзинами.
+ *
+ * Перебирает SAH_BIN_COUNT корзин по каждой оси, выбирает разбиение
+ * минимальной стоимости и переставляет order[start, end) на месте.
+ * Если центры всех примитивов совпадают, делит диапазон пополам.
+ *
+ * @param prims  сведения о примитивах (индексируются значениями order)
+ * @param order  перестановка индексов примитивов
+ */
+SAHSplit sah_partition(
+    const std::vector<BVHPrimitiveInfo>& prims,
+    std::vector<size_t>& order,
+    size_t start, size_t end
+);
+
 /**
  * @brief Ускоряющая структура BVH-узел для коллекции объектов.
  */
@@ -21,26 +59,56 @@ public:
     BVHNode(
         const std::vector<HittablePtr>& src_objects,
         size_t start, size_t end,
-        double time0, double time1
+        Real time0, Real time1
     );
 
-    bool hit(
+    bool intersect(
         const Ray& r,
-        double t_min,
-        double t_max,
+        Real t_min,
+        Real t_max,
+        Intersection& isect
+    ) const override;
+
+    // агрегат: попадание досчитывает isect.object, сюда вызов не доходит
+    void surface(
+        const Ray& r,
+        const Intersection& isect,
         HitRecord& rec
     ) const override;
 
+    bool occluded(
+        const Ray& r,
+        Real t_min,
+        Real t_max
+    ) const override;
+
     bool bounding_box(
-        double time0,
-        double time1,
+        Real time0,
+        Real time1,
         AABB& output_box
     ) const override;
 
+    /**
+     * @brief SAH-стоимость поддерева (ожидаемая цена луча, попавшего в box).
+     */
+    Real sah_cost() const;
+
+    int instance_nesting() const override { return nesting; }
+
 private:
+    void build(
+        const std::vector<HittablePtr>& objects,
+        const std::vector<BVHPrimitiveInfo>& prims,
+        std::vector<size_t>& order,
+        size_t start, size_t end,
+        Real time0, Real time1
+    );
+
     HittablePtr left;
     HittablePtr right;
     AABB        box;
+    Real        cost = 0.0;
+    int         nesting = 0;   // наибольшая вложенность экземпляров в поддереве
 };
 
 /**
@@ -1,19 +1,47 @@
 #pragma once
 #include "Hittable.h"
 #include "AABB.h"
+#include "Transform.h"
 
+/**
+ * @brief Сплошная коробка: пересечение считается одним slab-тестом,
+ * без построения граней, поэтому hit не выделяет память.
+ *
+ * Коробку можно повернуть вокруг её центра — тогда луч переводится
+ * в локальные координаты, где она снова выровнена по осям.
+ */
 class Box : public Hittable {
 public:
-    Point3 box_min, box_max;
+    Point3 box_min, box_max;   // углы до поворота
     std::shared_ptr<Material> mat_ptr;
 
     Box() {}
     Box(const Point3& p0, const Point3& p1, std::shared_ptr<Material> m)
       : box_min(p0), box_max(p1), mat_ptr(m) {}
 
-    virtual bool hit(const Ray& r, double t_min, double t_max, HitRecord& rec) const override;
-    virtual bool bounding_box(double, double, AABB& output_box) const override {
-        output_box = AABB(box_min, box_max);
-        return true;
-    }
+    /**
+     * @brief Коробка, повёрнутая вокруг своего центра.
+     * @param degrees  угол поворота в градусах
+     * @param axis     ось поворота
+     */
+    Box(const Point3& p0, const Point3& p1, std::shared_ptr<Material> m,
+        Real degrees, const Vec3& axis);
+
+    bool is_oriented() const { return oriented; }
+
+    virtual bool intersect(const Ray& r, Real t_min, Real t_max, Intersection& isect) const override;
+    virtual void surface(const Ray& r, const Intersection& isect, HitRecord& rec) const override;
+    virtual bool occluded(const Ray& r, Real t_min, Real t_max) const override;
+    virtual bool bounding_box(Real, Real, AABB& output_box) const override;
+
+private:
+    bool      oriented = false;
+    Transform orientation;   // локальные координаты -> мир
+
+    // луч в координатах коробки до поворота
+    Ray local_ray(const Ray& r) const;
+
+    // slab-тест в локальных координатах
+    bool slab(const Ray& local, Real t_min, Real t_max,
+              Real& t_hit, int& axis, bool& exit) const;
 };
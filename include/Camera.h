@@ -5,6 +5,16 @@
 
 #include "Vec3.h"
 #include "Ray.h"
+#include "RayPacket.h"
+#include "Sampler.h"
+
+/**
+ * @brief Проба первичного луча: точка (s,t) на экране и точка на линзе.
+ */
+struct CameraSample {
+    Real     s, t;
+    Sample2D lens;
+};
 
 /**
  * @brief Параметрическая камера с глубиной резкости.
@@ -16,7 +26,7 @@ public:
     Vec3   horizontal;
     Vec3   vertical;
     Vec3   u, v, w;
-    double lens_radius;
+    Real   lens_radius;
 
     /**
      * @param lookfrom  точка, откуда смотрим
@@ -32,19 +42,29 @@ public:
         Point3 lookfrom,
         Point3 lookat,
         Vec3   vup,
-        double vfov,
-        double aspect,
-        double aperture,
-        double focus_dist
+        Real   vfov,
+        Real   aspect,
+        Real   aperture,
+        Real   focus_dist
     );
 
     /**
      * @brief Сгенерировать луч, проходящий через точку (s,t) на экране.
      */
 
-    Ray get_ray(double s, double t) const;
+    Ray get_ray(Real s, Real t) const;
+
+    /**
+     * @brief То же с заданной 2D-пробой линзы (get_ray берёт её из сэмплера).
+     */
+    Ray get_ray(Real s, Real t, const Sample2D& lens) const;
+
+    /**
+     * @brief Пакет первичных лучей для count проб (count <= RAY_PACKET_MAX),
+     * интервал каждого — [surface_t_min, бесконечность).
+     */
+    void get_rays(const CameraSample* samples, int count, RayPacket& packet) const;
 
 private:
-    static double degrees_to_radians(double degrees);
-    static Vec3   random_in_unit_disk();
+    static Real degrees_to_radians(Real degrees);
 };
@@ -0,0 +1,76 @@
+// Контрольные точки рендера: буфер накопления (сумма яркости и
+// статистика проб каждого пикселя) периодически сохраняется в двоичный
+// файл, из которого рендер можно продолжить или добавить проб.
+#pragma once
+
+#include "AdaptiveSampling.h"
+#include "Sampler.h"
+#include "Vec3.h"
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Накопленное состояние пикселя.
+ *
+ * Пробы засеваются по (пиксель, номер пробы, кадр), поэтому состояние
+ * сэмплера — это просто stats.count: продолжение с этого номера даёт
+ * тот же результат, что и непрерывный рендер.
+ */
+struct PixelAccum {
+    Color      sum;     // сумма линейной яркости проб
+    PixelStats stats;   // число проб и статистика для адаптивной выборки
+};
+
+/**
+ * @brief Параметры рендера, с которыми совместима контрольная точка.
+ */
+struct CheckpointInfo {
+    int         width        = 0;
+    int         height       = 0;
+    SamplerType sampler_type = SamplerType::Independent;
+    uint32_t    frame_index  = 0;
+    // spp, на которое настроен сэмплер: от него зависит сетка страт
+    // Stratified, поэтому для него --resume --spp с другим N отклоняется
+    int         samples_per_pixel = 0;
+};
+
+/**
+ * @brief Буфер накопления кадра с сохранением и загрузкой.
+ *
+ * Потоки рендера читают пиксели своих тайлов без блокировки и
+ * публикуют готовый тайл через store_tile(). save() пишет файл блоками
+ * строк, каждый блок — под той же блокировкой: копии всего кадра нет.
+ * Тайл может попасть в файл частично старым, но каждый пиксель целиком —
+ * пиксель продолжает со своего числа проб, так что результат тот же.
+ */
+class AccumulationBuffer {
+public:
+    AccumulationBuffer(int width, int height);
+
+    const PixelAccum& at(int i, int j) const { return pixels[size_t(j) * width + i]; }
+
+    // записать тайл [x0, x0+w) × [y0, y0+h); src — w*h пикселей построчно
+    void store_tile(int x0, int y0, int w, int h, const PixelAccum* src);
+
+    /**
+     * @brief Записать контрольную точку: во временный файл, fsync и
+     * атомарная замена прежней (rename; MoveFileEx в Windows).
+     */
+    bool save(const std::string& path, const CheckpointInfo& info) const;
+
+    /**
+     * @brief Загрузить контрольную точку.
+     *
+     * @return false, если файла нет, он повреждён или не совпадает
+     *         с info (размер кадра, сэмплер, кадр, spp для Stratified);
+     *         error — причина
+     */
+    bool load(const std::string& path, const CheckpointInfo& info, std::string& error);
+
+private:
+    int                     width, height;
+    std::vector<PixelAccum> pixels;
+    mutable std::mutex      mutex;
+};
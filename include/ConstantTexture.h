@@ -9,7 +9,7 @@ class ConstantTexture : public Texture {
 public:
     Color color;
     ConstantTexture(const Color& c) : color(c) {}
-    virtual Color value(double /*u*/, double /*v*/, const Point3& /*p*/) const override {
+    virtual Color value(Real /*u*/, Real /*v*/, const Point3& /*p*/) const override {
         return color;
     }
 };
@@ -1,20 +1,27 @@
 // Определяет интерфейс «можно ли пересечь лучом».
-// HitRecord хранит точку пересечения, нормаль, материал.
+// Intersection — параметр попадания и примитив (фаза обхода),
+// HitRecord — точка пересечения, нормаль, материал (фаза поверхности).
 #pragma once
 
 #include "Ray.h"
+#include "RayPacket.h"
 #include "AABB.h"
+#include <algorithm>
+#include <cstdint>
 #include <memory>
+#include <vector>
 
 struct Material;
 
 struct HitRecord {
      Point3 p;
      Vec3 normal;
-     std::shared_ptr<Material> mat_ptr;
+     // невладеющий указатель: материалом владеет примитив, поэтому
+     // запись и копирование HitRecord не трогают счётчик ссылок
+     const Material* mat_ptr = nullptr;
 
-    double t;
-    double u, v;
+    Real t;
+    Real u, v;
      bool front_face;
 
      inline void set_face_normal(const Ray& r, const Vec3& outward_normal) {
@@ -23,26 +30,174 @@ struct HitRecord {
      }
  };
 
+class Hittable;
+
+// наибольшая вложенность экземпляров (Instance внутри Instance)
+constexpr int MAX_INSTANCE_DEPTH = 4;
+
+/**
+ * @brief Результат первой фазы поиска ближайшего попадания.
+ *
+ * Обход хранит только параметр t, примитив и его параметрические данные;
+ * точку, нормаль, UV и материал примитив досчитывает один раз — для
+ * окончательного ближайшего попадания (Hittable::surface).
+ */
+struct Intersection {
+    Real            t = 0.0;
+    Real            b0 = 0.0, b1 = 0.0, b2 = 0.0;   // барицентрики треугольника и т.п.
+    uint32_t        prim = 0;                       // треугольник сетки, грань коробки, ...
+    const Hittable* object = nullptr;               // примитив, которому досчитывать поверхность
+
+    // экземпляры, через которые найдено попадание: от внутреннего к внешнему
+    int             instance_depth = 0;
+    const Hittable* instances[MAX_INSTANCE_DEPTH];
+
+    /**
+     * @brief Записать попадание примитива; сбрасывает цепочку экземпляров,
+     * оставшуюся от прежнего, более дальнего попадания.
+     */
+    void set(Real t_hit, const Hittable* obj, uint32_t prim_id = 0,
+             Real p0 = 0.0, Real p1 = 0.0, Real p2 = 0.0) {
+        t = t_hit;
+        object = obj;
+        prim = prim_id;
+        b0 = p0;
+        b1 = p1;
+        b2 = p2;
+        instance_depth = 0;
+    }
+};
+
 class Hittable {
 public:
     virtual ~Hittable() = default;
 
-    // проверка пересечения луча с объектом
+    // первая фаза: ближайшее попадание в [t_min, t_max] без атрибутов поверхности;
+    // isect меняется только при успехе
+
+    virtual bool intersect(
+        const Ray& r,
+        Real t_min,
+        Real t_max,
+        Intersection& isect
+    ) const = 0;
 
-    virtual bool hit(
+    // вторая фаза: точка, нормаль, UV и материал для попадания из intersect;
+    // вызывается у isect.object (или у внешнего экземпляра). Чистая
+    // виртуальная: примитив без surface не скомпилируется, вместо того чтобы
+    // вернуть попадание с пустым HitRecord; агрегаты переопределяют её
+    // недостижимой заглушкой
+
+    virtual void surface(
         const Ray& r,
-        double t_min,
-        double t_max,
+        const Intersection& isect,
         HitRecord& rec
     ) const = 0;
 
+    // проверка пересечения луча с объектом: обе фазы подряд
+
+    bool hit(
+        const Ray& r,
+        Real t_min,
+        Real t_max,
+        HitRecord& rec
+    ) const {
+        Intersection isect;
+        if (!intersect(r, t_min, t_max, isect))
+            return false;
+        shade_intersection(r, isect, rec);
+        return true;
+    }
+
+    // досчитать поверхность: через внешний экземпляр, если он есть
+    static void shade_intersection(const Ray& r, const Intersection& isect, HitRecord& rec) {
+        const Hittable* owner = isect.instance_depth > 0
+            ? isect.instances[isect.instance_depth - 1]
+            : isect.object;
+        owner->surface(r, isect, rec);
+    }
+
+    // есть ли хоть одно пересечение в [t_min, t_max] — для теневых и AO-лучей;
+    // HitRecord не заполняется, обход останавливается на первом попадании
+
+    virtual bool occluded(
+        const Ray& r,
+        Real t_min,
+        Real t_max
+    ) const {
+        Intersection tmp;
+        return intersect(r, t_min, t_max, tmp);
+    }
+
+    // пакет лучей: первая фаза для каждого луча из маски active; возвращает
+    // маску лучей с попаданием, isects[k] меняется только у них.
+    // По умолчанию — intersect по очереди; BVH обходит пакет целиком
+
+    virtual uint32_t intersect_packet(
+        const RayPacket& packet,
+        uint32_t active,
+        Intersection* isects
+    ) const {
+        uint32_t hits = 0;
+        for (uint32_t m = active; m; m &= m - 1) {
+            int k = __builtin_ctz(m);
+            if (intersect(packet.rays[k], packet.t_min[k], packet.t_max[k], isects[k]))
+                hits |= 1u << k;
+        }
+        return hits;
+    }
+
+    // пакет лучей: обе фазы, как hit() для каждого луча
+
+    uint32_t hit_packet(
+        const RayPacket& packet,
+        uint32_t active,
+        HitRecord* recs
+    ) const {
+        Intersection isects[RAY_PACKET_MAX];
+        uint32_t hits = intersect_packet(packet, active, isects);
+        for (uint32_t m = hits; m; m &= m - 1) {
+            int k = __builtin_ctz(m);
+            shade_intersection(packet.rays[k], isects[k], recs[k]);
+        }
+        return hits;
+    }
+
+    // пакет теневых/AO-лучей: маска лучей, у которых есть пересечение
+
+    virtual uint32_t occluded_packet(
+        const RayPacket& packet,
+        uint32_t active
+    ) const {
+        uint32_t hits = 0;
+        for (uint32_t m = active; m; m &= m - 1) {
+            int k = __builtin_ctz(m);
+            if (occluded(packet.rays[k], packet.t_min[k], packet.t_max[k]))
+                hits |= 1u << k;
+        }
+        return hits;
+    }
+
     // получение ограничивающей коробки в заданный интервал времени
 
     virtual bool bounding_box(
-        double time0,
-        double time1,
+        Real time0,
+        Real time1,
         AABB& output_box
     ) const = 0;
+
+    // сколько Instance вложено друг в друга на пути к примитивам: 0 у
+    // примитивов, у агрегатов — наибольшая среди детей
+
+    virtual int instance_nesting() const { return 0; }
 };
 
 using HittablePtr = std::shared_ptr<Hittable>;
+
+// наибольшая вложенность экземпляров среди objects
+inline int max_instance_nesting(const std::vector<HittablePtr>& objects) {
+    int nesting = 0;
+    for (const HittablePtr& obj : objects)
+        nesting = std::max(nesting, obj->instance_nesting());
+    return nesting;
+}
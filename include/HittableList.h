@@ -15,18 +15,34 @@ public:
     void clear();
     void add(HittablePtr object);
 
-    bool hit(
+    bool intersect(
         const Ray& r,
-        double t_min,
-        double t_max,
+        Real t_min,
+        Real t_max,
+        Intersection& isect
+    ) const override;
+
+    // агрегат: попадание досчитывает isect.object, сюда вызов не доходит
+    void surface(
+        const Ray& r,
+        const Intersection& isect,
         HitRecord& rec
     ) const override;
 
+    bool occluded(
+        const Ray& r,
+        Real t_min,
+        Real t_max
+    ) const override;
+
     bool bounding_box(
-        double time0,
-        double time1,
+        Real time0,
+        Real time1,
         AABB& output_box
     ) const override;
 
+    // список можно менять после создания — считается при каждом вызове
+    int instance_nesting() const override { return max_instance_nesting(objects); }
+
     std::vector<HittablePtr> objects;
 };
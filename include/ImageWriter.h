@@ -0,0 +1,105 @@
+// Запись изображений: двоичный PPM (P6), текстовый PPM (P3),
+// PFM с линейной яркостью во float и PNG без внешних зависимостей,
+// а также потоковая запись по тайлам для очень больших кадров.
+#pragma once
+
+#include "Vec3.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Формат выходного файла.
+ */
+enum class ImageFormat {
+    PPMAscii,   // P3 — прежний текстовый вывод
+    PPM,        // P6 — 8 бит на канал, двоично
+    PFM,        // линейная яркость, 32-битный float на канал
+    PNG         // 8 бит на канал, deflate без сжатия (stored-блоки)
+};
+
+/**
+ * @brief Формат по расширению пути: .ppm → P6, .pfm → PFM, .png → PNG.
+ *
+ * Неизвестное расширение трактуется как P6.
+ */
+ImageFormat image_format_for_path(const std::string& path);
+
+/**
+ * @brief Гамма-коррекция (гамма 2), отсечение и квантование в 8 бит.
+ *
+ * Для count пикселей пишет 3*count байт RGB. NaN и отрицательные
+ * значения дают 0. При наличии AVX2 обрабатывает по 4 канала за такт.
+ */
+void quantize_rgb8(const Color* pixels, size_t count, uint8_t* out);
+
+/**
+ * @brief Записать 8-битное изображение; rgb — строки сверху вниз.
+ *
+ * @param format  PPMAscii, PPM или PNG
+ * @return false, если файл не удалось записать (или формат PFM)
+ */
+bool write_rgb8_image(const std::string& path, const uint8_t* rgb,
+                      int width, int height, ImageFormat format);
+
+/**
+ * @brief Записать кадр с линейной яркостью в формате по расширению пути.
+ *
+ * framebuffer хранит строки снизу вверх (j = 0 — нижняя строка), как
+ * его заполняет рендер. PFM получает линейные значения без изменений,
+ * остальные форматы — после quantize_rgb8().
+ */
+bool write_image(const std::string& path, const std::vector<Color>& framebuffer,
+                 int width, int height);
+
+/**
+ * @brief Потоковая запись кадра по тайлам прямо в файл (P6 или PFM).
+ *
+ * Файл сразу создаётся полного размера, а каждый готовый тайл пишется
+ * позиционированной записью (pwrite) на своё место — порядок готовности
+ * тайлов не важен, буфер переупорядочивания не нужен. В памяти остаются
+ * только буферы тайлов, поэтому расход не зависит от размера кадра.
+ * write_tile() можно вызывать из нескольких потоков одновременно.
+ */
+class StreamingImageWriter {
+public:
+    /**
+     * @param path  путь; формат по расширению, должен поддерживаться supports()
+     */
+    StreamingImageWriter(const std::string& path, int width, int height);
+    ~StreamingImageWriter();
+
+    StreamingImageWriter(const StreamingImageWriter&) = delete;
+    StreamingImageWriter& operator=(const StreamingImageWriter&) = delete;
+
+    // PNG требует сжатия всего потока целиком и потоково не пишется
+    static bool supports(ImageFormat format);
+
+    /**
+     * @brief Записать прямоугольник [x0, x0+w) × [y0, y0+h) линейных пикселей.
+     *
+     * pixels — w*h цветов построчно, начиная с нижней строки y0
+     * (та же раскладка, что у framebuffer).
+     */
+    void write_tile(int x0, int y0, int w, int h, const Color* pixels);
+
+    // файл открыт и все записи прошли успешно
+    bool ok() const;
+
+    const std::string& path() const { return file_path; }
+
+private:
+    bool write_at(uint64_t offset, const void* data, size_t size);
+
+    std::string file_path;
+    ImageFormat format;
+    int         width, height;
+    uint64_t    header_size = 0;
+    size_t      pixel_size  = 0;   // байт на пиксель в файле
+    int         fd          = -1;
+    std::mutex  io_mutex;          // только без pwrite (Windows): seek + write
+    std::atomic<bool> failed{false};
+};
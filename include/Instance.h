@@ -0,0 +1,63 @@
+// Экземпляр общей геометрии: ссылка на BLAS (нижнее BVH или сетку)
+// и аффинное преобразование. TLAS — обычное WideBVH над экземплярами,
+// поэтому память растёт с числом уникальных объектов, а не копий.
+#pragma once
+
+#include "Hittable.h"
+#include "Transform.h"
+
+/**
+ * @brief Экземпляр объекта blas, размещённый в мире преобразованием.
+ *
+ * Луч переводится в пространство объекта (направление не нормируется,
+ * поэтому t совпадает в обоих пространствах), точка и нормаль
+ * попадания — обратно в мир. Экземпляры можно вкладывать друг в друга
+ * не глубже MAX_INSTANCE_DEPTH.
+ */
+class Instance : public Hittable {
+public:
+    /**
+     * @param blas             общая геометрия (WideBVH, LinearBVH, TriangleMesh, ...)
+     * @param object_to_world  размещение экземпляра
+     *
+     * @throws std::invalid_argument  если вместе с экземплярами внутри blas
+     *         вложенность превысит MAX_INSTANCE_DEPTH
+     */
+    Instance(HittablePtr blas, const Transform& object_to_world);
+
+    bool intersect(
+        const Ray& r,
+        Real t_min,
+        Real t_max,
+        Intersection& isect
+    ) const override;
+
+    void surface(
+        const Ray& r,
+        const Intersection& isect,
+        HitRecord& rec
+    ) const override;
+
+    bool occluded(
+        const Ray& r,
+        Real t_min,
+        Real t_max
+    ) const override;
+
+    bool bounding_box(
+        Real time0,
+        Real time1,
+        AABB& output_box
+    ) const override;
+
+    int instance_nesting() const override { return nesting; }
+
+private:
+    Ray local_ray(const Ray& r) const;
+
+    HittablePtr blas;
+    Transform   object_to_world;
+    AABB        world_box;
+    bool        has_box = false;
+    int         nesting = 1;   // этот экземпляр и вложенные в blas
+};
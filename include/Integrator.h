@@ -0,0 +1,78 @@
+// Интеграторы освещения: рекурсивный ray_color() и итеративный
+// path tracer с русской рулеткой; выбираются через IntegratorSettings.
+#pragma once
+
+#include "Hittable.h"
+#include "Ray.h"
+#include "Vec3.h"
+
+// Параметры ambient occlusion
+struct AOSettings {
+    int    samples      = 32;    // число проб (можно уменьшить для скорости)
+    Real   max_distance = 2.0;   // дальше этого расстояния препятствия не затеняют
+    int    packet_size  = 1;     // лучей в пакете any-hit (до RAY_PACKET_MAX); 1 — каждый луч отдельно
+};
+
+enum class IntegratorType {
+    Recursive,   // исходный ray_color(): рекурсия до max_depth, AO на каждом диффузном отскоке
+    Path,        // итеративный цикл с пропускной способностью и русской рулеткой
+    Wavefront    // то же, что Path, но волнами путей (Wavefront.h); по одному лучу — Path
+};
+
+// Где итеративный интегратор считает AO
+enum class AOMode {
+    Off,
+    FirstDiffuse,   // только на первой диффузной вершине пути (видимая поверхность)
+    EveryBounce     // как в рекурсивном интеграторе
+};
+
+struct IntegratorSettings {
+    IntegratorType type      = IntegratorType::Recursive;
+    int            max_depth = 50;
+    AOSettings     ao;
+    AOMode         ao_mode   = AOMode::FirstDiffuse;   // только для Path и Wavefront
+    int            rr_depth  = 3;     // русская рулетка начиная с этого отскока
+    Real           rr_max_survival = 0.95;
+};
+
+/**
+ * @brief Фон: вертикальный градиент неба.
+ */
+Color background(const Ray& r);
+
+/**
+ * @brief Доля незатенённых направлений полусферы вокруг normal.
+ *
+ * Лучи из одной точки проверяются пакетами по ao.packet_size через
+ * Hittable::occluded_packet; пробы берутся в том же порядке, что и
+ * по одному лучу, — результат не зависит от размера пакета.
+ */
+Real ambient_occlusion(const Point3& p, const Vec3& normal, const Hittable& world,
+                       const AOSettings& ao);
+
+/**
+ * @brief Рекурсивная трассировка луча (исходный интегратор).
+ */
+Color ray_color(const Ray& r, const Hittable& world, int depth, const AOSettings& ao);
+
+/**
+ * @brief Итеративная трассировка пути с русской рулеткой.
+ *
+ * Путь несёт throughput — произведение ослаблений по всем вершинам.
+ * После rr_depth отскоков путь продолжается с вероятностью, равной
+ * наибольшей компоненте throughput (не больше rr_max_survival), а
+ * выживший вклад делится на эту вероятность — оценка остаётся несмещённой.
+ */
+Color path_color(const Ray& r, const Hittable& world, const IntegratorSettings& settings);
+
+/**
+ * @brief Радиация вдоль луча выбранным интегратором.
+ */
+Color integrate(const Ray& r, const Hittable& world, const IntegratorSettings& settings);
+
+/**
+ * @brief То же, когда первое попадание луча уже найдено (например, пакетом
+ * первичных лучей): found и rec — результат world.hit для r.
+ */
+Color integrate_hit(const Ray& r, bool found, const HitRecord& rec,
+                    const Hittable& world, const IntegratorSettings& settings);
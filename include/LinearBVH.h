@@ -0,0 +1,246 @@
+// Плоское BVH без указателей: узлы лежат в одном непрерывном массиве,
+// дети адресуются индексами, обход — итеративный с фиксированным стеком.
+#pragma once
+
+#include "Hittable.h"
+#include "BVH.h"
+#include "PrimitiveStore.h"
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+// Ограничение глубины: стек обхода не может переполниться
+constexpr int LINEAR_BVH_MAX_DEPTH = 64;
+
+/**
+ * @brief Узел плоского BVH (32 байта).
+ *
+ * Границы хранятся во float с округлением наружу. У внутреннего узла
+ * count == 0, а дети лежат рядом: left_first и left_first + 1.
+ * У листа count > 0, его примитивы — [left_first, left_first + count)
+ * в массиве порядка примитивов.
+ */
+struct LinearBVHNode {
+    float    bounds_min[3];
+    float    bounds_max[3];
+    uint32_t left_first;
+    uint32_t count;
+
+    bool is_leaf() const { return count > 0; }
+    // записать границы с округлением Real -> float наружу
+    void set_bounds(const AABB& b);
+};
+
+static_assert(sizeof(LinearBVHNode) == 32, "LinearBVHNode must be 32 bytes");
+
+/**
+ * @brief Построить плоское BVH по SAH над набором примитивов.
+ *
+ * @param prims     коробки и центры примитивов
+ * @param max_leaf  максимум примитивов в листе
+ * @param nodes     [out] узлы, корень — nodes[0]
+ * @param order     [out] индексы примитивов в порядке листьев
+ */
+void build_linear_bvh(
+    const std::vector<BVHPrimitiveInfo>& prims,
+    int max_leaf,
+    std::vector<LinearBVHNode>& nodes,
+    std::vector<uint32_t>& order
+);
+
+/**
+ * @brief SAH-стоимость плоского BVH (ожидаемая цена луча, попавшего в корень).
+ */
+Real linear_bvh_sah_cost(const std::vector<LinearBVHNode>& nodes);
+
+/**
+ * @brief Упорядочить примитивы внутри каждого листа по PrimitiveKind.
+ *
+ * Границы листов не меняются; switch по типу в листе становится
+ * предсказуемым, а подряд идущие примитивы одного типа лежат подряд
+ * в массивах PrimitiveStore.
+ */
+void group_leaves_by_kind(
+    const std::vector<LinearBVHNode>& nodes,
+    const std::vector<HittablePtr>& objects,
+    std::vector<uint32_t>& order
+);
+
+/**
+ * @brief Луч, подготовленный для slab-тестов во float.
+ */
+struct LinearBVHRay {
+    float origin[3];
+    float inv_dir[3];
+
+    explicit LinearBVHRay(const Ray& r) {
+        for (int a = 0; a < 3; ++a) {
+            origin[a]  = static_cast<float>(r.origin[a]);
+            inv_dir[a] = static_cast<float>(r.inv_direction[a]);
+        }
+    }
+};
+
+/**
+ * @brief Slab-тест узла: дистанция входа луча или +inf при промахе.
+ */
+inline float linear_bvh_node_entry(
+    const LinearBVHNode& node,
+    const LinearBVHRay& ray,
+    float t_min,
+    float t_max
+) {
+    for (int a = 0; a < 3; ++a) {
+        float t0 = (node.bounds_min[a] - ray.origin[a]) * ray.inv_dir[a];
+        float t1 = (node.bounds_max[a] - ray.origin[a]) * ray.inv_dir[a];
+        if (ray.inv_dir[a] < 0.0f) std::swap(t0, t1);
+        t_min = t0 > t_min ? t0 : t_min;
+        t_max = t1 < t_max ? t1 : t_max;
+    }
+    return t_min <= t_max ? t_min : std::numeric_limits<float>::infinity();
+}
+
+/**
+ * @brief Итеративный обход плоского BVH, ближний ребёнок — первым.
+ *
+ * @tparam AnyHit  остановиться на первом листе с попаданием (теневые лучи)
+ * @param  leaf    leaf(first, count, t_max) проверяет примитивы листа,
+ *                 уменьшает t_max при попадании и возвращает true
+ * @return         было ли хотя бы одно попадание
+ */
+template <bool AnyHit = false, typename LeafFn>
+bool traverse_linear_bvh(
+    const LinearBVHNode* nodes,
+    const Ray& r,
+    Real t_min,
+    Real& t_max,
+    LeafFn&& leaf
+) {
+    const float inf = std::numeric_limits<float>::infinity();
+    LinearBVHRay ray(r);
+
+    struct StackEntry {
+        uint32_t node;
+        float    entry;
+    };
+    StackEntry stack[LINEAR_BVH_MAX_DEPTH];
+    int        sp = 0;
+
+    float tmin = static_cast<float>(t_min);
+    if (linear_bvh_node_entry(nodes[0], ray, tmin, static_cast<float>(t_max)) == inf)
+        return false;
+
+    bool     hit_anything = false;
+    uint32_t current      = 0;
+    while (true) {
+        const LinearBVHNode& node = nodes[current];
+        if (node.is_leaf()) {
+            if (leaf(node.left_first, node.count, t_max)) {
+                if (AnyHit) return true;
+                hit_anything = true;
+            }
+        } else {
+            float    far_t = static_cast<float>(t_max);
+            uint32_t near_child = node.left_first;
+            uint32_t far_child  = node.left_first + 1;
+            float    d_near = linear_bvh_node_entry(nodes[near_child], ray, tmin, far_t);
+            float    d_far  = linear_bvh_node_entry(nodes[far_child],  ray, tmin, far_t);
+            if (d_far < d_near) {
+                std::swap(d_near, d_far);
+                std::swap(near_child, far_child);
+            }
+            if (d_near != inf) {
+                if (d_far != inf)
+                    stack[sp++] = { far_child, d_far };
+                current = near_child;
+                continue;
+            }
+        }
+
+        // Снимаем со стека первый узел, который ещё ближе найденного попадания
+        bool found = false;
+        while (sp > 0) {
+            StackEntry e = stack[--sp];
+            if (e.entry <= t_max) {
+                current = e.node;
+                found   = true;
+                break;
+            }
+        }
+        if (!found) break;
+    }
+    return hit_anything;
+}
+
+struct ParallelBVHOptions;
+
+/**
+ * @brief Плоское BVH над коллекцией Hittable-объектов.
+ */
+class LinearBVH : public Hittable {
+public:
+    /**
+     * @param objects        объекты сцены
+     * @param time0          начало интервала времени
+     * @param time1          конец интервала времени
+     * @param max_leaf_size  максимум объектов в листе
+     */
+    LinearBVH(
+        const std::vector<HittablePtr>& objects,
+        Real time0, Real time1,
+        int max_leaf_size = 4
+    );
+
+    /**
+     * @brief Параллельное построение по кодам Мортона (см. ParallelBVH.h).
+     */
+    LinearBVH(
+        const std::vector<HittablePtr>& objects,
+        Real time0, Real time1,
+        const ParallelBVHOptions& options
+    );
+
+    bool intersect(
+        const Ray& r,
+        Real t_min,
+        Real t_max,
+        Intersection& isect
+    ) const override;
+
+    // агрегат: попадание досчитывает isect.object, сюда вызов не доходит
+    void surface(
+        const Ray& r,
+        const Intersection& isect,
+        HitRecord& rec
+    ) const override;
+
+    bool occluded(
+        const Ray& r,
+        Real t_min,
+        Real t_max
+    ) const override;
+
+    bool bounding_box(
+        Real time0,
+        Real time1,
+        AABB& output_box
+    ) const override;
+
+    size_t node_count() const { return nodes.size(); }
+    Real sah_cost() const;
+
+    int instance_nesting() const override { return nesting; }
+
+private:
+    void init_primitives(
+        const std::vector<BVHPrimitiveInfo>& prims,
+        const std::vector<uint32_t>& order
+    );
+
+    std::vector<LinearBVHNode> nodes;
+    PrimitiveStore             primitives;    // геометрия в порядке листьев
+    std::vector<HittablePtr>   objects;       // владение объектами
+    AABB                       box;
+    int                        nesting = 0;   // наибольшая вложенность экземпляров
+};
@@ -15,8 +15,8 @@ inline Vec3 reflect(const Vec3& v, const Vec3& n) {
     return v - 2*dot(v,n)*n;
 }
 
-inline Vec3 refract(const Vec3& uv, const Vec3& n, double etai_over_etat) {
-    double cos_theta = dot(-uv, n);
+inline Vec3 refract(const Vec3& uv, const Vec3& n, Real etai_over_etat) {
+    Real cos_theta = dot(-uv, n);
     Vec3 r_out_perp =  etai_over_etat * (uv + cos_theta*n);
     Vec3 r_out_parallel = -std::sqrt(fabs(1.0 - r_out_perp.length_squared())) * n;
     return r_out_perp + r_out_parallel;
@@ -62,8 +62,8 @@ public:
 class Metal : public Material {
 public:
     Color albedo;
-    double fuzz;
-    Metal(const Color& a, double f);
+    Real fuzz;
+    Metal(const Color& a, Real f);
     virtual bool scatter(
         const Ray& r_in,
         const HitRecord& rec,
@@ -73,7 +73,8 @@ public:
 
 class Dielectric : public Material {
 public:
-    explicit Dielectric(double index_of_refraction);
+    explicit Dielectric(Real index_of_refraction);
+    Real index_of_refraction() const { return ir; }
 
     virtual bool scatter(
         const Ray& r_in,
@@ -82,8 +83,8 @@ public:
     ) const override;
 
 private:
-    double ir;
-    static double reflectance(double cosine, double ref_idx);
+    Real ir;
+    static Real reflectance(Real cosine, Real ref_idx);
 };
 
 
@@ -7,10 +7,11 @@
 class NoiseTexture : public Texture {
 public:
     Perlin noise;
-    double scale;
-    NoiseTexture(double sc = 1.0) : scale(sc) {}
-    virtual Color value(double u, double v, const Point3& p) const override {
-        double t = 0.5*(1 + sin(scale*p.z + 10*noise.turb(p)));
+    Real scale;
+    NoiseTexture(Real sc = 1.0) : scale(sc) {}
+    NoiseTexture(Real sc, uint64_t perlin_seed) : noise(perlin_seed), scale(sc) {}
+    virtual Color value(Real u, Real v, const Point3& p) const override {
+        Real t = 0.5*(1 + sin(scale*p.z + 10*noise.turb(p)));
         return Color(1,1,1) * t;
     }
 };
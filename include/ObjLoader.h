@@ -0,0 +1,43 @@
+// Потоковый загрузчик Wavefront OBJ: файл читается построчно, в памяти
+// остаются только итоговые буферы сетки.
+#pragma once
+
+#include "TriangleMesh.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Буферы сетки, прочитанные из OBJ.
+ *
+ * Разные комбинации индексов v/vt/vn одной грани сводятся к общим
+ * вершинам, поэтому все буферы индексируются одним массивом indices.
+ */
+struct ObjMeshData {
+    std::vector<Point3>   positions;
+    std::vector<Vec3>     normals;    // пусто, если в файле нет vn
+    std::vector<UV>       uvs;        // пусто, если в файле нет vt
+    std::vector<uint32_t> indices;    // по 3 на треугольник
+};
+
+/**
+ * @brief Прочитать OBJ: строки v, vt, vn и f (многоугольники режутся веером).
+ *
+ * Поддерживаются форматы граней v, v/vt, v//vn, v/vt/vn и
+ * отрицательные (относительные) индексы; прочие директивы пропускаются.
+ *
+ * @return false и причина в error при ошибке чтения или разбора
+ */
+bool load_obj(const std::string& path, ObjMeshData& mesh, std::string& error);
+
+/**
+ * @brief Загрузить OBJ сразу в TriangleMesh с одним материалом.
+ *
+ * @return nullptr и причина в error при ошибке
+ */
+std::shared_ptr<TriangleMesh> load_obj_mesh(
+    const std::string& path,
+    std::shared_ptr<Material> material,
+    std::string& error,
+    const ParallelBVHOptions& options = ParallelBVHOptions()
+);
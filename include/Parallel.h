@@ -0,0 +1,50 @@
+// Минимальные параллельные примитивы поверх std::thread.
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Число рабочих потоков по умолчанию (не меньше одного).
+ */
+inline int default_thread_count() {
+    unsigned n = std::thread::hardware_concurrency();
+    return n > 0 ? static_cast<int>(n) : 1;
+}
+
+/**
+ * @brief Выполнить fn(i) для всех i из [0, count) на thread_count потоках.
+ *
+ * Индексы раздаются динамически кусками по grain через атомарный счётчик,
+ * поэтому задачи разной длительности балансируются сами. При
+ * thread_count <= 1 всё выполняется в вызывающем потоке.
+ */
+template <typename Fn>
+void parallel_for(size_t count, int thread_count, Fn&& fn, size_t grain = 1) {
+    if (grain == 0) grain = 1;
+    size_t chunks  = (count + grain - 1) / grain;
+    size_t workers = std::min<size_t>(chunks, thread_count > 0 ? thread_count : 1);
+    if (workers <= 1) {
+        for (size_t i = 0; i < count; ++i) fn(i);
+        return;
+    }
+
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t begin = next.fetch_add(grain); begin < count; begin = next.fetch_add(grain)) {
+            size_t end = std::min(begin + grain, count);
+            for (size_t i = begin; i < end; ++i)
+                fn(i);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(workers - 1);
+    for (size_t t = 1; t < workers; ++t)
+        threads.emplace_back(worker);
+    worker();
+    for (auto& th : threads) th.join();
+}
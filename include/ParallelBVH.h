@@ -0,0 +1,56 @@
+// Параллельное построение плоского BVH: коды Мортона, поразрядная
+// сортировка и сборка поддеревьев (treelet) на нескольких потоках.
+#pragma once
+
+#include "LinearBVH.h"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Биты кода Мортона, задающие treelet: верхние 12 из 30
+constexpr int LBVH_TREELET_BITS = 12;
+
+/**
+ * @brief Параметры параллельного построения.
+ */
+struct ParallelBVHOptions {
+    int  max_leaf_size = 4;
+    // примитивы листа проверяются пачками (SphereBatch.h): SAH оценивает
+    // лист из n примитивов как ceil(n / leaf_batch_size) тестов
+    int  leaf_batch_size = 1;
+    int  thread_count  = 1;
+    // перестроить каждый treelet по SAH вместо разбиения по битам Мортона
+    bool sah_refine    = true;
+};
+
+/**
+ * @brief 30-битный код Мортона точки из единичного куба.
+ */
+uint32_t morton_code_3d(double x, double y, double z);
+
+/**
+ * @brief Параллельная поразрядная сортировка пар (код, индекс) по коду.
+ *
+ * Сортировка устойчивая; используются 8-битные разряды и гистограммы
+ * по кускам массива, считающиеся на отдельных потоках.
+ */
+void radix_sort_morton(
+    std::vector<std::pair<uint32_t, uint32_t>>& items,
+    int thread_count
+);
+
+/**
+ * @brief Построить плоское BVH по кодам Мортона (LBVH/HLBVH).
+ *
+ * Примитивы сортируются по коду Мортона центра, затем диапазоны с
+ * общими верхними LBVH_TREELET_BITS битами собираются в независимые
+ * treelet-ы параллельно — разбиением по старшему различающемуся биту
+ * или, при sah_refine, по SAH. Верхние уровни над treelet-ами строятся
+ * по SAH. Результат совместим с build_linear_bvh().
+ */
+void build_linear_bvh_parallel(
+    const std::vector<BVHPrimitiveInfo>& prims,
+    const ParallelBVHOptions& options,
+    std::vector<LinearBVHNode>& nodes,
+    std::vector<uint32_t>& order
+);
@@ -1,21 +1,26 @@
 #pragma once
 #include "Vec3.h"
 #include <array>
+#include <cstdint>
 #include <numeric>
-#include <random>
 
 class Perlin {
 public:
     Perlin();
-    double noise(const Point3& p) const;
-    double turb(const Point3& p, int depth=7) const;
+    // шум с заданным зерном перестановки (для загрузки сцены из файла)
+    explicit Perlin(uint64_t seed);
+    uint64_t seed() const { return perm_seed; }
+    Real noise(const Point3& p) const;
+    Real turb(const Point3& p, int depth=7) const;
 
 private:
     static const int pointCount = 256;
     std::array<int, pointCount*2> perm;
+    uint64_t perm_seed = 0;
 
-    static std::array<int, pointCount> generate_perm();
-    static double fade(double t);
-    static double lerp(double t, double a, double b);
-    static double grad(int hash, double x, double y, double z);
+    // перестановка из фиксированного зерна: шум одинаков от запуска к запуску
+    static std::array<int, pointCount> generate_perm(uint64_t seed);
+    static Real fade(Real t);
+    static Real lerp(Real t, Real a, Real b);
+    static Real grad(int hash, Real x, Real y, Real z);
 };
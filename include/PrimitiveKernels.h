@@ -0,0 +1,107 @@
+// Ядра пересечения простых примитивов без виртуальных вызовов.
+// Ими пользуются и сами классы (Sphere, XYRect, ..., Box), и плотные
+// массивы PrimitiveStore, поэтому результат обоих путей совпадает бит в бит.
+#pragma once
+
+#include "Ray.h"
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+/**
+ * @brief Ближайший корень пересечения со сферой в [t_min, t_max].
+ *
+ * Центр передаётся по координатам: так его можно читать прямо из SoA-массивов.
+ */
+inline bool intersect_sphere(
+    Real cx, Real cy, Real cz, Real radius,
+    const Ray& r, Real t_min, Real t_max,
+    Real& t
+) {
+    const Vec3& o = r.origin;
+    const Vec3& d = r.direction;
+    Real ox = o.x - cx, oy = o.y - cy, oz = o.z - cz;
+    Real a = d.x*d.x + d.y*d.y + d.z*d.z;
+    Real half_b = ox*d.x + oy*d.y + oz*d.z;
+    Real c = (ox*ox + oy*oy + oz*oz) - radius*radius;
+    Real discriminant = half_b*half_b - a*c;
+    if (discriminant < 0) return false;
+    Real sqrtd = std::sqrt(discriminant);
+
+    // сравнения записаны так, чтобы NaN (вырожденный луч) отвергался —
+    // как и в SIMD-ядрах SphereBatch
+    Real root = (-half_b - sqrtd) / a;
+    if (!(root >= t_min && root <= t_max)) {
+        root = (-half_b + sqrtd) / a;
+        if (!(root >= t_min && root <= t_max))
+            return false;
+    }
+    t = root;
+    return true;
+}
+
+/**
+ * @brief Прямоугольник [a0, a1] × [b0, b1] в плоскости K = k.
+ *
+ * Оси задаются указателями на члены Vec3, поэтому обращения к координатам
+ * разрешаются при компиляции.
+ * @param a, b  [out] координаты точки попадания в плоскости (для UV)
+ */
+template <Real Vec3::*A, Real Vec3::*B, Real Vec3::*K>
+inline bool intersect_axis_rect(
+    Real a0, Real a1, Real b0, Real b1, Real k,
+    const Ray& r, Real t0, Real t1,
+    Real& t, Real& a, Real& b
+) {
+    t = (k - r.origin.*K) / r.direction.*K;
+    if (t < t0 || t > t1) return false;
+    a = r.origin.*A + t*r.direction.*A;
+    b = r.origin.*B + t*r.direction.*B;
+    return !(a < a0 || a > a1 || b < b0 || b > b1);
+}
+
+/**
+ * @brief Slab-тест сплошной коробки, выровненной по осям.
+ * @param box_min, box_max  углы коробки по осям x, y, z
+ * @param t_hit  ближайший параметр в [t_min, t_max]
+ * @param axis   ось грани, через которую прошёл луч
+ * @param exit   true, если это выход из коробки (начало луча внутри)
+ */
+inline bool intersect_box_slab(
+    const Real box_min[3], const Real box_max[3],
+    const Ray& r, Real t_min, Real t_max,
+    Real& t_hit, int& axis, bool& exit
+) {
+    static constexpr Real Vec3::* coord[3] = { &Vec3::x, &Vec3::y, &Vec3::z };
+    const Real* bounds[2] = { box_min, box_max };
+    Real t_near = -std::numeric_limits<Real>::infinity();
+    Real t_far  =  std::numeric_limits<Real>::infinity();
+    int axis_near = 0, axis_far = 0;
+    for (int a = 0; a < 3; ++a) {
+        Real o   = r.origin.*coord[a];
+        Real inv = r.inv_direction.*coord[a];
+        Real t0 = (bounds[r.sign[a]][a]     - o) * inv;
+        Real t1 = (bounds[1 - r.sign[a]][a] - o) * inv;
+        if (t0 > t_near) { t_near = t0; axis_near = a; }
+        if (t1 < t_far)  { t_far  = t1; axis_far  = a; }
+    }
+    if (t_near > t_far) return false;
+    if (t_near >= t_min && t_near <= t_max) {
+        t_hit = t_near;
+        axis  = axis_near;
+        exit  = false;
+        return true;
+    }
+    if (t_far >= t_min && t_far <= t_max) {
+        t_hit = t_far;
+        axis  = axis_far;
+        exit  = true;
+        return true;
+    }
+    return false;
+}
+
+// грань коробки в Intersection::prim: ось и признак выхода
+inline uint32_t box_face_id(int axis, bool exit) {
+    return uint32_t(axis) | (exit ? 4u : 0u);
+}
@@ -0,0 +1,90 @@
+// Примитивы BVH в плотных массивах по типам: лист проверяется через
+// switch по типу примитива, без виртуальных вызовов и прыжков по куче.
+#pragma once
+
+#include "Hittable.h"
+#include "SphereBatch.h"
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Типы примитивов, у которых в PrimitiveStore свои массивы.
+ *
+ * Other — всё остальное (сетки, экземпляры, повёрнутые коробки, вложенные
+ * BVH): такие объекты проверяются через интерфейс Hittable.
+ */
+enum class PrimitiveKind : uint32_t { Sphere, XYRect, XZRect, YZRect, Box, Other };
+
+/**
+ * @brief Тип объекта для PrimitiveStore.
+ */
+PrimitiveKind primitive_kind(const Hittable* obj);
+
+/**
+ * @brief Геометрия листьев BVH, разложенная по типам.
+ *
+ * Слот i соответствует i-му примитиву в порядке листьев; в refs[i]
+ * записаны тип и индекс в массиве этого типа. Сферы хранятся SoA
+ * (отдельные массивы координат центра и радиусов), и идущие подряд сферы
+ * листа проверяются одним пакетным SIMD-ядром (SphereBatch.h); прямоугольники
+ * и коробки — плотными массивами небольших записей. Исходный объект
+ * слота нужен только второй фазе (Hittable::surface) для ближайшего
+ * попадания и для типа Other.
+ */
+class PrimitiveStore {
+public:
+    PrimitiveStore() = default;
+
+    /**
+     * @param objects  объекты сцены
+     * @param order    индексы objects в порядке листьев BVH
+     */
+    void build(const std::vector<HittablePtr>& objects, const std::vector<uint32_t>& order);
+
+    /**
+     * @brief Ближайшее попадание среди слотов [first, first + count).
+     * @param closest  верхняя граница t; уменьшается при попадании
+     */
+    bool intersect(
+        uint32_t first, uint32_t count,
+        const Ray& r, Real t_min, Real& closest,
+        Intersection& isect
+    ) const;
+
+    /**
+     * @brief Есть ли попадание среди слотов [first, first + count).
+     */
+    bool occluded(
+        uint32_t first, uint32_t count,
+        const Ray& r, Real t_min, Real t_max
+    ) const;
+
+    size_t size() const { return refs.size(); }
+
+private:
+    static constexpr uint32_t KIND_SHIFT = 29;
+    static constexpr uint32_t INDEX_MASK = (1u << KIND_SHIFT) - 1;
+
+    struct SphereArrays {
+        std::vector<Real> cx, cy, cz, radius;
+    };
+
+    // прямоугольник [a0, a1] × [b0, b1] в плоскости k
+    struct RectData {
+        Real a0, a1, b0, b1, k;
+    };
+
+    struct BoxData {
+        Real box_min[3], box_max[3];
+    };
+
+    // число сфер подряд, начиная со слота i (не дальше end)
+    uint32_t sphere_run(uint32_t i, uint32_t end) const;
+
+    std::vector<uint32_t>        refs;       // (тип << KIND_SHIFT) | индекс в массиве типа
+    std::vector<const Hittable*> owners;     // исходный объект слота, без владения
+    SphereArrays                 spheres;
+    std::vector<RectData>        rects[3];   // XY, XZ, YZ
+    std::vector<BoxData>         boxes;
+    SphereBatchKernel            sphere_batch = intersect_spheres_scalar;
+};
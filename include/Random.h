@@ -0,0 +1,79 @@
+// Быстрый генератор случайных чисел PCG32 и детерминированное
+// засевание по (пиксель, проба, кадр): результат рендера не зависит
+// от числа потоков и порядка обработки тайлов.
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief Перемешивающая функция splitmix64 (финализатор).
+ */
+inline uint64_t mix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+/**
+ * @brief Генератор PCG32 (XSH-RR): 64 бита состояния, 32 бита на выходе.
+ */
+class Rng {
+public:
+    uint64_t state = 0x853C49E6748FEA9Bull;
+    uint64_t inc   = 0xDA3E39CB94B95BDBull;   // номер потока, всегда нечётный
+
+    Rng() = default;
+    Rng(uint64_t seed_value, uint64_t stream) { seed(seed_value, stream); }
+
+    void seed(uint64_t seed_value, uint64_t stream) {
+        state = 0;
+        inc   = (stream << 1) | 1u;
+        next_u32();
+        state += seed_value;
+        next_u32();
+    }
+
+    uint32_t next_u32() {
+        uint64_t old = state;
+        state = old * 6364136223846793005ull + inc;
+        uint32_t xorshifted = static_cast<uint32_t>(((old >> 18) ^ old) >> 27);
+        uint32_t rot        = static_cast<uint32_t>(old >> 59);
+        return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+    }
+
+    // равномерно в [0, 1)
+    double next_double() {
+        return next_u32() * (1.0 / 4294967296.0);
+    }
+
+    // равномерно в [0, 1) во float: старшие 24 бита — ровно мантисса,
+    // округление как у (float)next_double() до 1.0f невозможно
+    float next_float() {
+        return (next_u32() >> 8) * 0x1p-24f;
+    }
+
+    // равномерно в [0, bound)
+    uint32_t next_bounded(uint32_t bound) {
+        return static_cast<uint32_t>((uint64_t(next_u32()) * bound) >> 32);
+    }
+};
+
+/**
+ * @brief Генератор текущего потока; им пользуются камера, материалы и Vec3::random().
+ */
+inline Rng& thread_rng() {
+    static thread_local Rng rng;
+    return rng;
+}
+
+/**
+ * @brief Засеять генератор потока для пробы sample пикселя pixel в кадре frame.
+ *
+ * Одна и та же тройка всегда даёт одну и ту же последовательность,
+ * поэтому рендер воспроизводим бит в бит при любом расписании.
+ */
+inline void seed_thread_rng(uint64_t pixel, uint32_t sample, uint32_t frame) {
+    uint64_t h = mix64(mix64(pixel ^ (uint64_t(frame) << 40)) + sample);
+    thread_rng().seed(h, mix64(h));
+}
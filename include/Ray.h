@@ -6,17 +6,43 @@
 
 /**
  * @brief Класс луча: точка начала и направление.
+ *
+ * Обратное направление и знаки его компонент считаются один раз
+ * в конструкторе и используются всеми slab-тестами коробок.
  */
 class Ray {
 public:
     Point3 origin;
     Vec3   direction;
+    Vec3   inv_direction;   // 1 / direction по компонентам
+    int    sign[3];         // 1, если компонента inv_direction отрицательна
 
-    Ray();
+    Ray() : sign{0, 0, 0} {}   // встроен: пакеты (RayPacket.h) создают лучи массивами
     Ray(const Point3& origin, const Vec3& direction);
 
     /**
      * @brief Возвращает точку на луче с параметром t.
      */
-    Point3 at(double t) const;
+    Point3 at(Real t) const;
 };
+
+/**
+ * @brief Наименьшее t для луча, выпущенного с поверхности.
+ *
+ * Обычно RAY_T_MIN; если начало луча далеко от начала координат и
+ * ошибка его координат (Real.h) больше, t_min растёт вместе с ней.
+ */
+inline Real surface_t_min(const Ray& r) {
+    const Real err  = REAL_RELATIVE_ERROR * max_abs_component(r.origin);
+    const Real len2 = r.direction.length_squared();
+    if (err * err <= RAY_T_MIN * RAY_T_MIN * len2)
+        return RAY_T_MIN;
+    return err / std::sqrt(len2);
+}
+
+/**
+ * @brief Начало луча, сдвинутое от точки поверхности p вдоль нормали n.
+ */
+inline Point3 offset_ray_origin(const Point3& p, const Vec3& n) {
+    return p + robust_epsilon(RAY_OFFSET, max_abs_component(p)) * n;
+}
@@ -0,0 +1,34 @@
+// Пакет когерентных лучей (первичные лучи соседних пикселей, AO-лучи из
+// одной точки): BVH обходится один раз на пакет с общим стеком, а какие
+// лучи ещё участвуют, задаёт битовая маска.
+#pragma once
+
+#include "Ray.h"
+#include <cstdint>
+
+// Наибольший размер пакета: маски лучей — 32-битные
+constexpr int RAY_PACKET_MAX = 16;
+
+/**
+ * @brief До RAY_PACKET_MAX лучей со своими интервалами [t_min, t_max].
+ *
+ * Бит k маски активных лучей соответствует rays[k].
+ */
+struct RayPacket {
+    Ray  rays[RAY_PACKET_MAX];
+    Real t_min[RAY_PACKET_MAX];
+    Real t_max[RAY_PACKET_MAX];
+    int  count = 0;
+
+    void add(const Ray& r, Real t0, Real t1) {
+        rays[count]  = r;
+        t_min[count] = t0;
+        t_max[count] = t1;
+        ++count;
+    }
+
+    bool full() const { return count == RAY_PACKET_MAX; }
+
+    // маска всех лучей пакета
+    uint32_t all() const { return (1u << count) - 1; }
+};
@@ -0,0 +1,47 @@
+// Real: скалярный тип геометрии, лучей и цвета. По умолчанию double;
+// сборка с -DRT_REAL_FLOAT переводит весь конвейер на float — вдвое
+// меньше памяти на узлы, примитивы и кадр и вдвое шире SIMD.
+// Генератор случайных чисел, статистика проб и форматы файлов
+// (сцена, контрольные точки) остаются в double.
+#pragma once
+
+#include <algorithm>
+#include <limits>
+
+#ifdef RT_REAL_FLOAT
+using Real = float;
+#else
+using Real = double;
+#endif
+
+constexpr Real REAL_INFINITY = std::numeric_limits<Real>::infinity();
+
+/**
+ * @brief Наименьшее t для лучей, выпущенных с поверхности.
+ *
+ * Отсекает самопересечение из-за ошибки округления точки попадания.
+ */
+constexpr Real RAY_T_MIN = Real(0.001);
+
+/**
+ * @brief Сдвиг начала луча вдоль нормали (лучи AO).
+ */
+constexpr Real RAY_OFFSET = Real(1e-4);
+
+/**
+ * @brief Относительная ошибка координаты точки попадания.
+ *
+ * Точка, посчитанная как origin + t*direction, ошибается примерно на
+ * несколько ulp своей наибольшей координаты; берём запас в 64 эпсилон.
+ * Для double это ~1e-14 и постоянные RAY_T_MIN / RAY_OFFSET не меняются
+ * в сценах любого разумного размера; для float (~8e-6) вдали от начала
+ * координат отступы растут вместе с ошибкой.
+ */
+constexpr Real REAL_RELATIVE_ERROR = 64 * std::numeric_limits<Real>::epsilon();
+
+/**
+ * @brief Отступ не меньше base и не меньше ошибки координаты величиной magnitude.
+ */
+inline Real robust_epsilon(Real base, Real magnitude) {
+    return std::max(base, REAL_RELATIVE_ERROR * magnitude);
+}
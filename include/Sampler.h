@@ -0,0 +1,194 @@
+// Сэмплеры: выдают для каждой пробы пикселя последовательность 1D/2D
+// измерений. Малорасхождённые последовательности (стратификация, Халтон,
+// Соболь) дают тот же уровень шума за меньшее число проб.
+#pragma once
+
+#include "Random.h"
+#include "Vec3.h"
+#include <cmath>
+#include <cstdint>
+#include <memory>
+
+/**
+ * @brief Точка двумерной выборки в [0,1)^2.
+ */
+struct Sample2D {
+    double x, y;
+};
+
+/**
+ * @brief Интерфейс сэмплера.
+ *
+ * Перед каждой пробой вызывается start_pixel_sample(); дальше get_1d()
+ * и get_2d() отдают очередные измерения этой пробы. Значения зависят
+ * только от (пиксель, номер пробы, измерение, зерно) — рендер
+ * детерминирован при любом расписании потоков.
+ */
+class Sampler {
+public:
+    /**
+     * @param samples_per_pixel  сколько проб на пиксель будет запрошено
+     * @param seed               зерно (например, номер кадра)
+     */
+    Sampler(int samples_per_pixel, uint32_t seed);
+    virtual ~Sampler() = default;
+
+    // начать пробу sample_index пикселя pixel_index; сбрасывает номер измерения
+    virtual void start_pixel_sample(uint64_t pixel_index, int sample_index);
+
+    virtual double   get_1d() = 0;
+    virtual Sample2D get_2d() = 0;
+
+    // независимая копия для другого потока
+    virtual std::unique_ptr<Sampler> clone() const = 0;
+
+    int samples_per_pixel() const { return spp; }
+
+    /**
+     * @brief Положение внутри пробы: пиксель, номер пробы, измерение и
+     * генератор потока. Позволяет отложить пробу (например, пока пакет
+     * первичных лучей трассируется целиком) и продолжить её с того же места.
+     */
+    struct State {
+        uint64_t pixel;
+        int      sample;
+        int      dimension;
+        Rng      rng;
+    };
+
+    State save_state() const { return { pixel, sample, dimension, thread_rng() }; }
+
+    void restore_state(const State& state) {
+        pixel        = state.pixel;
+        sample       = state.sample;
+        dimension    = state.dimension;
+        thread_rng() = state.rng;
+    }
+
+protected:
+    // хеш текущих (пиксель, измерение) с зерном
+    uint64_t dimension_hash(int dim) const;
+
+    int      spp;
+    uint32_t seed;
+    uint64_t pixel     = 0;
+    int      sample    = 0;
+    int      dimension = 0;
+};
+
+enum class SamplerType {
+    Independent,   // независимые равномерные числа (PCG32)
+    Stratified,    // джиттер в перемешанных стратах по каждому измерению
+    Halton,        // последовательность Халтона с перемешиванием цифр Оуэна
+    Sobol          // Соболь с перемешиванием Оуэна (по два первых измерения)
+};
+
+/**
+ * @brief Создать сэмплер заданного типа.
+ */
+std::unique_ptr<Sampler> make_sampler(SamplerType type, int samples_per_pixel, uint32_t seed);
+
+class IndependentSampler : public Sampler {
+public:
+    using Sampler::Sampler;
+    double   get_1d() override;
+    Sample2D get_2d() override;
+    std::unique_ptr<Sampler> clone() const override;
+};
+
+class StratifiedSampler : public Sampler {
+public:
+    StratifiedSampler(int samples_per_pixel, uint32_t seed);
+    double   get_1d() override;
+    Sample2D get_2d() override;
+    std::unique_ptr<Sampler> clone() const override;
+
+private:
+    int x_strata, y_strata;   // сетка страт для 2D-измерений
+};
+
+class HaltonSampler : public Sampler {
+public:
+    using Sampler::Sampler;
+    double   get_1d() override;
+    Sample2D get_2d() override;
+    std::unique_ptr<Sampler> clone() const override;
+
+private:
+    double halton(int dim);
+};
+
+class SobolSampler : public Sampler {
+public:
+    using Sampler::Sampler;
+    double   get_1d() override;
+    Sample2D get_2d() override;
+    std::unique_ptr<Sampler> clone() const override;
+};
+
+/**
+ * @brief Сэмплер, назначенный текущему потоку рендера (или nullptr).
+ */
+inline Sampler*& thread_sampler() {
+    static thread_local Sampler* sampler = nullptr;
+    return sampler;
+}
+
+/**
+ * @brief Очередное 1D-измерение: из сэмплера потока, иначе из PCG32.
+ *
+ * Через эти функции случайные числа получают камера, материалы и AO.
+ */
+inline double sample_1d() {
+    Sampler* s = thread_sampler();
+    return s ? s->get_1d() : thread_rng().next_double();
+}
+
+inline Sample2D sample_2d() {
+    Sampler* s = thread_sampler();
+    if (s) return s->get_2d();
+    double x = thread_rng().next_double();
+    double y = thread_rng().next_double();
+    return { x, y };
+}
+
+// --- Отображения [0,1)^2 на области без отбраковки ---------------------------
+// Каждой точке квадрата соответствует ровно одна точка области, поэтому
+// стратификация сэмплера сохраняется.
+
+/**
+ * @brief Концентрическое отображение Ширли–Чиу на единичный диск (z = 0).
+ */
+inline Vec3 sample_unit_disk_concentric(const Sample2D& u) {
+    double ox = 2.0 * u.x - 1.0;
+    double oy = 2.0 * u.y - 1.0;
+    if (ox == 0.0 && oy == 0.0)
+        return Vec3(0, 0, 0);
+    double r, theta;
+    if (std::fabs(ox) > std::fabs(oy)) {
+        r     = ox;
+        theta = (M_PI / 4.0) * (oy / ox);
+    } else {
+        r     = oy;
+        theta = (M_PI / 2.0) - (M_PI / 4.0) * (ox / oy);
+    }
+    return Vec3(r * std::cos(theta), r * std::sin(theta), 0.0);
+}
+
+/**
+ * @brief Равномерное направление на единичной сфере.
+ */
+inline Vec3 sample_unit_sphere(const Sample2D& u) {
+    double z   = 1.0 - 2.0 * u.x;
+    double r   = std::sqrt(std::fmax(0.0, 1.0 - z * z));
+    double phi = 2.0 * M_PI * u.y;
+    return Vec3(r * std::cos(phi), r * std::sin(phi), z);
+}
+
+/**
+ * @brief Равномерное направление в полусфере вокруг normal.
+ */
+inline Vec3 sample_hemisphere(const Vec3& normal, const Sample2D& u) {
+    Vec3 d = sample_unit_sphere(u);
+    return dot(d, normal) < 0.0 ? -d : d;
+}
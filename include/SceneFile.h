@@ -0,0 +1,58 @@
+// Двоичный формат сцены (.rtsc): текстуры, материалы, примитивы и
+// готовое плоское BVH. Файл отображается в память (mmap), BVH берётся
+// из него как есть и не перестраивается. Объекты сцены (Hittable,
+// материалы, текстуры) по записям всё же создаются заново: они нужны
+// второй фазе попадания и типам Other, поэтому загрузка линейна по числу
+// примитивов, хотя и намного дешевле построения BVH.
+#pragma once
+
+#include "Hittable.h"
+#include "HittableList.h"
+#include "LinearBVH.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct ParallelBVHOptions;
+
+// Версия формата; файлы другой версии не загружаются
+constexpr uint32_t SCENE_FILE_VERSION = 1;
+
+/**
+ * @brief Сцена, загруженная из файла.
+ */
+struct LoadedScene {
+    std::vector<HittablePtr>   objects;     // примитивы в порядке записи
+    std::vector<LinearBVHNode> bvh_nodes;   // плоское BVH над objects
+    std::vector<uint32_t>      bvh_order;   // индексы objects в порядке листьев
+};
+
+/**
+ * @brief Записать сцену из HittableList вместе с построенным для неё BVH.
+ *
+ * Поддерживаются Sphere, XYRect, XZRect, YZRect и Box; материалы
+ * Lambertian, Metal, Dielectric, DiffuseLight; текстуры ConstantTexture,
+ * NoiseTexture, WoodTexture. Общие материалы и текстуры пишутся один раз.
+ *
+ * @return false и причина в error, если встретился неподдерживаемый тип
+ *         или файл не удалось записать
+ */
+bool write_scene_file(
+    const std::string& path,
+    const HittableList& world,
+    const ParallelBVHOptions& options,
+    std::string& error
+);
+
+/**
+ * @brief Загрузить сцену, отобразив файл в память.
+ *
+ * Узлы BVH и порядок примитивов проверяются перед использованием:
+ * order — перестановка, дерево непусто при непустой сцене, дети
+ * внутреннего узла лежат после него, глубина не больше
+ * LINEAR_BVH_MAX_DEPTH, листья покрывают каждый примитив ровно один раз.
+ *
+ * @return false и причина в error, если файл не найден, повреждён
+ *         или другой версии
+ */
+bool load_scene_file(const std::string& path, LoadedScene& scene, std::string& error);
@@ -0,0 +1,12 @@
+// Наборы SIMD-инструкций: выбор ядра во время работы по процессору.
+#pragma once
+
+/**
+ * @brief Доступные наборы инструкций для slab-тестов и пакетных ядер.
+ */
+enum class SimdLevel { Scalar, SSE, AVX2 };
+
+/**
+ * @brief Лучший набор инструкций, поддерживаемый процессором во время работы.
+ */
+SimdLevel detect_simd_level();
@@ -7,13 +7,15 @@
 class Sphere : public Hittable {
 public:
     Point3 center;
-    double radius;
+    Real radius;
     std::shared_ptr<Material> mat_ptr;
 
     Sphere();
-    Sphere(Point3 cen, double r, std::shared_ptr<Material> m);
+    Sphere(Point3 cen, Real r, std::shared_ptr<Material> m);
 
 
-    bool hit(const Ray& r, double t_min, double t_max, HitRecord& rec) const override;
-    bool bounding_box(double time0, double time1, AABB& output_box) const override;
+    bool intersect(const Ray& r, Real t_min, Real t_max, Intersection& isect) const override;
+    void surface(const Ray& r, const Intersection& isect, HitRecord& rec) const override;
+    bool occluded(const Ray& r, Real t_min, Real t_max) const override;
+    bool bounding_box(Real time0, Real time1, AABB& output_box) const override;
 };
@@ -0,0 +1,37 @@
+// Пакетный тест луча против нескольких сфер из SoA-массивов:
+// AVX2 решает 4 квадратных уравнения за раз, SSE2 — 2, плюс скалярный путь.
+// Во float (RT_REAL_FLOAT) дорожек вдвое больше: 8 и 4.
+#pragma once
+
+#include "Ray.h"
+#include "Simd.h"
+#include <cstdint>
+
+/**
+ * @brief Ядро пакетного теста: ближайшее попадание среди сфер [0, count).
+ *
+ * Корни считаются теми же операциями, что и в intersect_sphere, поэтому
+ * результат совпадает с последовательным скалярным тестом бит в бит;
+ * при равных t выигрывает сфера с большим номером, как и там.
+ *
+ * @param cx, cy, cz, radius  SoA-массивы центров и радиусов
+ * @param t_max  [in/out] верхняя граница t; при попадании — найденный корень
+ * @param index  [out] номер сферы с ближайшим корнем
+ */
+using SphereBatchKernel = bool (*)(
+    const Real* cx, const Real* cy, const Real* cz, const Real* radius,
+    uint32_t count, const Ray& r, Real t_min, Real& t_max, uint32_t& index
+);
+
+/**
+ * @brief Скалярный вариант: intersect_sphere по очереди.
+ */
+bool intersect_spheres_scalar(
+    const Real* cx, const Real* cy, const Real* cz, const Real* radius,
+    uint32_t count, const Ray& r, Real t_min, Real& t_max, uint32_t& index
+);
+
+/**
+ * @brief Ядро для набора инструкций simd (или ближайшего доступного при сборке).
+ */
+SphereBatchKernel sphere_batch_kernel(SimdLevel simd);
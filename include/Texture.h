@@ -6,6 +6,6 @@
 class Texture {
 public:
     // возвращает цвет по координатам (u,v) и по месту попадания p
-    virtual Color value(double u, double v, const Point3& p) const = 0;
+    virtual Color value(Real u, Real v, const Point3& p) const = 0;
     virtual ~Texture() = default;
 };
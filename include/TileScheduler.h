@@ -0,0 +1,88 @@
+// Планировщик рендера по тайлам: тайлы раздаются потокам в очередях
+// (deque) с перехватом работы (work stealing) у занятых соседей.
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Прямоугольник пикселей [x0, x1) × [y0, y1).
+ */
+struct Tile {
+    int x0, y0;
+    int x1, y1;
+
+    int width()  const { return x1 - x0; }
+    int height() const { return y1 - y0; }
+};
+
+/**
+ * @brief Порядок обхода тайлов.
+ */
+enum class TileOrder {
+    Scanline,   // построчно сверху вниз
+    Morton,     // Z-кривая: соседние по номеру тайлы соседствуют на экране
+    Spiral      // от центра кадра наружу
+};
+
+struct TileSchedulerOptions {
+    int       tile_size    = 32;
+    TileOrder order        = TileOrder::Morton;
+    int       thread_count = 1;
+};
+
+/**
+ * @brief Загрузка одного потока за время рендера.
+ */
+struct WorkerStats {
+    double busy_seconds = 0.0;   // внутри render_tile
+    double idle_seconds = 0.0;   // поиск работы и ожидание остальных
+    int    tiles        = 0;     // обработано тайлов
+    int    stolen       = 0;     // из них перехвачено у других потоков
+};
+
+class TileScheduler {
+public:
+    /**
+     * @param width    ширина изображения в пикселях
+     * @param height   высота изображения в пикселях
+     * @param options  размер тайла, порядок обхода, число потоков
+     */
+    TileScheduler(int width, int height, const TileSchedulerOptions& options);
+
+    /**
+     * @brief Отрендерить все тайлы; блокирует до завершения.
+     *
+     * render_tile(tile, worker) вызывается ровно один раз для каждого
+     * тайла; worker — номер потока в [0, thread_count), его можно
+     * использовать как индекс собственных буферов потока.
+     */
+    void run(const std::function<void(const Tile&, int)>& render_tile);
+
+    const std::vector<Tile>&        tiles() const { return tile_list; }
+    const std::vector<WorkerStats>& stats() const { return worker_stats; }
+    int                             thread_count() const { return workers; }
+
+    /**
+     * @brief Напечатать занятость и простой каждого потока.
+     */
+    void print_stats(std::ostream& out) const;
+
+private:
+    struct WorkQueue {
+        std::mutex      mutex;
+        std::deque<int> tiles;
+    };
+
+    bool pop_local(int worker, int& tile);
+    bool steal(int thief, int& tile);
+
+    std::vector<Tile>                       tile_list;
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<WorkerStats>                worker_stats;
+    int                                     workers;
+};
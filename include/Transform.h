@@ -0,0 +1,45 @@
+// Аффинное преобразование 3×4 вместе с обратным: точки, векторы,
+// нормали и коробки переводятся между пространством объекта и мира.
+#pragma once
+
+#include "Vec3.h"
+#include "AABB.h"
+
+/**
+ * @brief Аффинное преобразование с заранее посчитанной обратной матрицей.
+ *
+ * Композиция A * B сначала применяет B, затем A.
+ */
+class Transform {
+public:
+    Transform();   // тождественное
+
+    static Transform translate(const Vec3& offset);
+    static Transform scale(const Vec3& factors);
+    static Transform scale(Real factor);
+    // поворот на degrees градусов вокруг оси axis (через начало координат)
+    static Transform rotate(Real degrees, const Vec3& axis);
+
+    Transform operator*(const Transform& other) const;
+    Transform inverse() const;
+
+    Point3 point(const Point3& p) const;
+    Vec3   vector(const Vec3& v) const;
+    // нормаль переводится обратной транспонированной матрицей
+    Vec3   normal(const Vec3& n) const;
+    // коробка, охватывающая образ всех 8 углов
+    AABB   box(const AABB& b) const;
+
+    Point3 inverse_point(const Point3& p) const;
+    Vec3   inverse_vector(const Vec3& v) const;
+
+private:
+    /**
+     * @param linear  линейная часть 3×3 (по строкам)
+     * @param offset  сдвиг
+     */
+    Transform(const Real linear[3][3], const Vec3& offset);
+
+    Real m[3][4];       // прямое преобразование
+    Real m_inv[3][4];   // обратное
+};
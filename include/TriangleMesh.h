@@ -0,0 +1,83 @@
+// Индексированная треугольная сетка: общие буферы вершин, нормалей и UV,
+// 32-битные индексы и собственное плоское BVH над треугольниками.
+// Треугольник — это не отдельный Hittable, а номер в буфере индексов,
+// поэтому сетки из миллионов треугольников занимают мало памяти.
+#pragma once
+
+#include "Hittable.h"
+#include "LinearBVH.h"
+#include "ParallelBVH.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Текстурные координаты вершины.
+ */
+struct UV {
+    Real u, v;
+};
+
+/**
+ * @brief Треугольная сетка как один объект сцены.
+ *
+ * Нормали и UV необязательны; если заданы, индексируются теми же
+ * индексами, что и позиции. Пересечение — водонепроницаемый алгоритм
+ * Woop–Benthin–Wald: луч не проходит между соседними треугольниками.
+ */
+class TriangleMesh : public Hittable {
+public:
+    /**
+     * @param positions  вершины
+     * @param indices    по 3 индекса на треугольник
+     * @param material   материал всей сетки
+     * @param normals    нормали вершин (пусто — геометрическая нормаль)
+     * @param uvs        UV вершин (пусто — барицентрические координаты)
+     * @param options    параметры построения BVH над треугольниками
+     */
+    TriangleMesh(
+        std::vector<Point3> positions,
+        std::vector<uint32_t> indices,
+        std::shared_ptr<Material> material,
+        std::vector<Vec3> normals = {},
+        std::vector<UV> uvs = {},
+        const ParallelBVHOptions& options = ParallelBVHOptions()
+    );
+
+    bool intersect(
+        const Ray& r,
+        Real t_min,
+        Real t_max,
+        Intersection& isect
+    ) const override;
+
+    void surface(
+        const Ray& r,
+        const Intersection& isect,
+        HitRecord& rec
+    ) const override;
+
+    bool occluded(
+        const Ray& r,
+        Real t_min,
+        Real t_max
+    ) const override;
+
+    bool bounding_box(
+        Real time0,
+        Real time1,
+        AABB& output_box
+    ) const override;
+
+    size_t triangle_count() const { return indices.size() / 3; }
+    size_t vertex_count()   const { return positions.size(); }
+
+private:
+    std::vector<Point3>        positions;
+    std::vector<Vec3>          normals;
+    std::vector<UV>            uvs;
+    std::vector<uint32_t>      indices;   // переупорядочены: листья BVH ссылаются на отрезки
+    std::vector<LinearBVHNode> nodes;
+    std::shared_ptr<Material>  mat_ptr;
+    AABB                       box;
+};
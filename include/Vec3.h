@@ -1,49 +1,176 @@
 // Vec3: Вектор/точка в 3D.
 // Содержит операции +, -, *, /, скалярное и векторное произведение,
 // а также генерацию случайных векторов.
+//
+// Всё определено в заголовке как inline/constexpr: операции встраиваются
+// в горячие циклы (пересечения, BVH, материалы) без вызовов через единицы
+// трансляции. Порядок операций в формулах не меняется — рендер совпадает
+// с прежним бит в бит.
+//
+// Компоненты — Real (Real.h): double или, при сборке с RT_REAL_FLOAT, float.
+//
+// RT_VEC3_SIMD4 (по умолчанию выключено): четвёртая дорожка-заполнитель и
+// выравнивание по 4 компонентам, чтобы вектор занимал ровно один регистр
+// (AVX для double, SSE/NEON для float) и компилятор мог векторизовать
+// операции целиком. Цена — на треть больше памяти на каждую точку и цвет.
 #pragma once
+#include "Random.h"
+#include "Real.h"
+
 #include <cmath>
 #include <iostream>
 
-class Vec3 {
+#ifdef RT_VEC3_SIMD4
+#define RT_VEC3_ALIGN alignas(4 * sizeof(Real))
+#else
+#define RT_VEC3_ALIGN
+#endif
+
+class RT_VEC3_ALIGN Vec3 {
 public:
-    double x, y, z;
+    Real x, y, z;
+#ifdef RT_VEC3_SIMD4
+    Real w = 0;   // заполнитель дорожки, всегда 0
+#endif
+
+    constexpr Vec3() : x(0), y(0), z(0) {}
+    constexpr Vec3(Real e0, Real e1, Real e2) : x(e0), y(e1), z(e2) {}
+
+    constexpr Vec3 operator-() const { return Vec3(-x, -y, -z); }
+
+    constexpr Vec3& operator+=(const Vec3& v) {
+        x += v.x; y += v.y; z += v.z;
+        return *this;
+    }
 
-    Vec3();
-    Vec3(double e0, double e1, double e2);
+    constexpr Vec3& operator*=(Real t) {
+        x *= t; y *= t; z *= t;
+        return *this;
+    }
 
-    Vec3 operator-() const;
-    Vec3& operator+=(const Vec3& v);
-    Vec3& operator*=(double t);
-    Vec3& operator/=(double t);
+    constexpr Vec3& operator/=(Real t) { return *this *= 1/t; }
 
-    double length() const;
-    double length_squared() const;
+    constexpr Real length_squared() const { return x*x + y*y + z*z; }
+    Real length() const { return std::sqrt(length_squared()); }
 
     static Vec3 random();
-    static Vec3 random(double min, double max);
+    static Vec3 random(Real min, Real max);
 
-    double operator[](int i) const;
-    double& operator[](int i);
+    // Компонента по номеру оси 0/1/2: выборка через таблицу указателей
+    // на члены, без цепочки сравнений
+    constexpr Real    operator[](int i) const;
+    constexpr Real& operator[](int i);
 };
 
+#undef RT_VEC3_ALIGN
 
 using Point3 = Vec3;
 using Color  = Vec3;
 
-std::ostream& operator<<(std::ostream &out, const Vec3 &v);
-Vec3 operator+(const Vec3 &u, const Vec3 &v);
-Vec3 operator-(const Vec3 &u, const Vec3 &v);
-Vec3 operator*(const Vec3 &u, const Vec3 &v);
-Vec3 operator*(double t, const Vec3 &v);
-Vec3 operator*(const Vec3 &v, double t);
-Vec3 operator/(Vec3 v, double t);
-double dot(const Vec3 &u, const Vec3 &v);
-Vec3 cross(const Vec3 &u, const Vec3 &v);
-Vec3 unit_vector(Vec3 v);
-
-// Глобальный генератор одного случайного double в [0,1)
-double random_double();
+namespace vec3_detail {
+    constexpr Real Vec3::* axes[3] = { &Vec3::x, &Vec3::y, &Vec3::z };
+}
+
+constexpr Real    Vec3::operator[](int i) const { return this->*vec3_detail::axes[i]; }
+constexpr Real& Vec3::operator[](int i)       { return this->*vec3_detail::axes[i]; }
+
+inline std::ostream& operator<<(std::ostream &out, const Vec3 &v) {
+    return out << v.x << ' ' << v.y << ' ' << v.z;
+}
+
+constexpr Vec3 operator+(const Vec3 &u, const Vec3 &v) {
+    return Vec3(u.x + v.x, u.y + v.y, u.z + v.z);
+}
+
+constexpr Vec3 operator-(const Vec3 &u, const Vec3 &v) {
+    return Vec3(u.x - v.x, u.y - v.y, u.z - v.z);
+}
+
+constexpr Vec3 operator*(const Vec3 &u, const Vec3 &v) {
+    return Vec3(u.x * v.x, u.y * v.y, u.z * v.z);
+}
+
+constexpr Vec3 operator*(Real t, const Vec3 &v) {
+    return Vec3(t * v.x, t * v.y, t * v.z);
+}
+
+constexpr Vec3 operator*(const Vec3 &v, Real t) {
+    return t * v;
+}
+
+constexpr Vec3 operator/(Vec3 v, Real t) {
+    return (1/t) * v;
+}
+
+constexpr Real dot(const Vec3 &u, const Vec3 &v) {
+    return u.x * v.x + u.y * v.y + u.z * v.z;
+}
+
+constexpr Vec3 cross(const Vec3 &u, const Vec3 &v) {
+    return Vec3(
+        u.y * v.z - u.z * v.y,
+        u.z * v.x - u.x * v.z,
+        u.x * v.y - u.y * v.x
+    );
+}
+
+inline Vec3 unit_vector(Vec3 v) {
+    return v / v.length();
+}
+
+inline Real max_abs_component(const Vec3& v) {
+    return std::max({ std::fabs(v.x), std::fabs(v.y), std::fabs(v.z) });
+}
+
+// Одно случайное double в [0,1) / [min,max) из генератора потока (Random.h)
+inline double random_double() {
+    return thread_rng().next_double();
+}
+
+inline double random_double(double min, double max) {
+    return min + (max - min) * thread_rng().next_double();
+}
+
+namespace vec3_detail {
+    // равномерно в [0,1) в типе Real
+    inline Real random_unit(Rng& rng) {
+#ifdef RT_REAL_FLOAT
+        return rng.next_float();
+#else
+        return rng.next_double();
+#endif
+    }
+
+    // min + (max - min) * u; во float сумма может округлиться до max
+    inline Real random_in(Real min, Real max, Real u) {
+        Real v = min + (max - min) * u;
+#ifdef RT_REAL_FLOAT
+        v = std::min(v, std::nextafter(max, min));
+#endif
+        return v;
+    }
+}
+
+inline Vec3 Vec3::random() {
+    Rng& rng = thread_rng();
+    Real x = vec3_detail::random_unit(rng);
+    Real y = vec3_detail::random_unit(rng);
+    Real z = vec3_detail::random_unit(rng);
+    return Vec3(x, y, z);
+}
+
+inline Vec3 Vec3::random(Real min, Real max) {
+    Rng& rng = thread_rng();
+    Real x = vec3_detail::random_unit(rng);
+    Real y = vec3_detail::random_unit(rng);
+    Real z = vec3_detail::random_unit(rng);
+    return Vec3(vec3_detail::random_in(min, max, x),
+                vec3_detail::random_in(min, max, y),
+                vec3_detail::random_in(min, max, z));
+}
+
+static_assert(Vec3(1, 2, 3)[1] == 2 && dot(Vec3(1, 0, 0), cross(Vec3(0, 1, 0), Vec3(0, 0, 1))) == 1,
+              "Vec3 должен вычисляться на этапе компиляции");
 
 // Случайная точка в полусфере вокруг данной нормали
 inline Vec3 random_in_hemisphere(const Vec3& normal) {
@@ -0,0 +1,100 @@
+// Волновой (wavefront) интегратор: вместо того чтобы вести один путь от
+// камеры до конца, держит очередь из многих путей и проходит её стадиями —
+// трассировка всех лучей очереди, сортировка попаданий по типу материала
+// и октанту направления, затенение каждой группы отдельным циклом, пакетная
+// трассировка AO-лучей, русская рулетка. Код материала одного типа идёт
+// подряд и не вытесняет из кэша обход BVH и остальные материалы.
+#pragma once
+
+#include "Hittable.h"
+#include "Integrator.h"
+#include "Ray.h"
+#include "RayPacket.h"
+#include "Sampler.h"
+#include "Vec3.h"
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Тип материала для группировки попаданий.
+ *
+ * Other — материал, чей тип не совпадает в точности ни с одним из
+ * известных (в том числе наследники): он затеняется виртуальными вызовами.
+ */
+enum class MaterialKind : uint8_t { Lambertian, Metal, Dielectric, DiffuseLight, Other };
+
+constexpr int MATERIAL_KIND_COUNT = 5;
+
+MaterialKind material_kind(const Material* mat);
+
+/**
+ * @brief Волновой интегратор семантики IntegratorType::Path.
+ *
+ * Каждый путь несёт своё положение в сэмплере (Sampler::State), поэтому
+ * пробы берутся в том же порядке, что и у path_color(), — цвет пути
+ * совпадает с ним бит в бит, как бы ни были перемешаны стадии.
+ * Очереди хранятся в объекте и переиспользуются между вызовами: на поток
+ * рендера — свой экземпляр.
+ */
+class WavefrontIntegrator {
+public:
+    /**
+     * @param world        сцена
+     * @param settings     max_depth, AO, русская рулетка (как у Path)
+     * @param packet_size  лучей волны в пакете hit_packet (до RAY_PACKET_MAX);
+     *                     1 — каждый луч отдельно через world.hit
+     */
+    WavefrontIntegrator(const Hittable& world, const IntegratorSettings& settings,
+                        int packet_size = 1);
+
+    /**
+     * @brief Досчитать count путей до конца.
+     *
+     * @param rays     первичные лучи путей
+     * @param states   положение сэмплера после генерации каждого луча
+     * @param count    число путей
+     * @param sampler  сэмплер потока (thread_sampler()), через него пути берут пробы
+     * @param colors   результат: радиация вдоль каждого пути
+     */
+    void trace(const Ray* rays, const Sampler::State* states, int count,
+               Sampler& sampler, Color* colors);
+
+private:
+    struct PathState {
+        Ray            ray;          // луч, который трассируется в этой волне
+        Color          throughput;
+        Sampler::State sampler;
+        int            index;        // номер пути во входных массивах
+        bool           ao_done;
+    };
+
+    // AO-лучи одного пути: пакеты [first_packet, first_packet + packets)
+    struct AOJob {
+        int first_packet;
+        int packets;
+        int occluded;
+    };
+
+    void trace_rays();
+    void sort_hits(Color* colors);
+    void shade_hits(Sampler& sampler, Color* colors);
+    void trace_ao();
+    void finish_bounce(int bounce, Sampler& sampler);
+
+    template <typename M>
+    void shade_group(const uint32_t* begin, const uint32_t* end, Sampler& sampler, Color* colors);
+
+    const Hittable&    world;
+    IntegratorSettings settings;
+    int                packet_size;   // лучей волны в пакете
+
+    std::vector<PathState> paths, next_paths;
+    std::vector<HitRecord> hits;
+    std::vector<uint8_t>   found;
+    std::vector<uint8_t>   alive;        // путь продолжится после затенения
+    std::vector<uint16_t>  keys;         // тип материала * 8 + октант луча
+    std::vector<uint32_t>  order;        // попадания, отсортированные по keys
+    std::vector<uint32_t>  group_start;  // начало каждой группы ключа в order
+    std::vector<AOJob>     ao_jobs;      // по пути; packets = 0 — без AO
+    std::vector<RayPacket> ao_packets;
+};
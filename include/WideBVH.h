@@ -0,0 +1,141 @@
+// Широкое BVH (4 или 8 детей на узел): границы детей хранятся по осям
+// (SoA), и один SIMD slab-тест проверяет всех детей узла сразу.
+#pragma once
+
+#include "Hittable.h"
+#include "LinearBVH.h"
+#include "Simd.h"
+#include <cstdint>
+#include <vector>
+
+struct ParallelBVHOptions;
+
+// Пустой слот узла
+constexpr uint32_t WIDE_BVH_EMPTY = 0xFFFFFFFFu;
+
+/**
+ * @brief Узел широкого BVH на W детей.
+ *
+ * Для слота i: count[i] > 0 — лист с примитивами [child[i], child[i] + count[i]),
+ * count[i] == 0 — внутренний узел child[i] (или WIDE_BVH_EMPTY).
+ * У пустых слотов min = +inf, max = -inf, и slab-тест их всегда отвергает.
+ */
+template <int W>
+struct alignas(32) WideBVHNode {
+    float    bounds[6][W];   // min_x, min_y, min_z, max_x, max_y, max_z
+    uint32_t child[W];
+    uint32_t count[W];
+};
+
+/**
+ * @brief Свернуть бинарное плоское BVH в широкое на W детей.
+ *
+ * Каждый широкий узел забирает детей бинарного, раскрывая внутренних
+ * детей с наибольшей площадью, пока слотов не станет W. Листья и порядок
+ * примитивов остаются прежними.
+ */
+template <int W>
+void collapse_linear_bvh(
+    const std::vector<LinearBVHNode>& binary,
+    std::vector<WideBVHNode<W>>& wide
+);
+
+/**
+ * @brief BVH4/BVH8 над коллекцией Hittable-объектов.
+ */
+class WideBVH : public Hittable {
+public:
+    /**
+     * @param objects  объекты сцены
+     * @param time0    начало интервала времени
+     * @param time1    конец интервала времени
+     * @param options  параметры построения бинарного дерева
+     * @param width    4, 8 или 0 — выбрать по процессору (AVX2 -> 8, иначе 4)
+     */
+    WideBVH(
+        const std::vector<HittablePtr>& objects,
+        Real time0, Real time1,
+        const ParallelBVHOptions& options,
+        int width = 0
+    );
+
+    /**
+     * @brief Из готового бинарного BVH (например, загруженного из файла сцены):
+     *        выполняется только свёртка, без построения.
+     *
+     * @param binary  узлы плоского BVH над objects
+     * @param order   индексы objects в порядке листьев
+     */
+    WideBVH(
+        const std::vector<HittablePtr>& objects,
+        const std::vector<LinearBVHNode>& binary,
+        const std::vector<uint32_t>& order,
+        int width = 0
+    );
+
+    bool intersect(
+        const Ray& r,
+        Real t_min,
+        Real t_max,
+        Intersection& isect
+    ) const override;
+
+    // агрегат: попадание досчитывает isect.object, сюда вызов не доходит
+    void surface(
+        const Ray& r,
+        const Intersection& isect,
+        HitRecord& rec
+    ) const override;
+
+    bool occluded(
+        const Ray& r,
+        Real t_min,
+        Real t_max
+    ) const override;
+
+    /**
+     * @brief Пакет лучей (RayPacket.h) одним обходом с общим стеком.
+     */
+    uint32_t intersect_packet(
+        const RayPacket& packet,
+        uint32_t active,
+        Intersection* isects
+    ) const override;
+
+    uint32_t occluded_packet(
+        const RayPacket& packet,
+        uint32_t active
+    ) const override;
+
+    bool bounding_box(
+        Real time0,
+        Real time1,
+        AABB& output_box
+    ) const override;
+
+    int       width() const { return node_width; }
+    SimdLevel simd_level() const { return simd; }
+    size_t    node_count() const;
+
+    int instance_nesting() const override { return nesting; }
+
+private:
+    // свернуть бинарное дерево и разложить примитивы в порядке листьев
+    void init_from_binary(
+        const std::vector<LinearBVHNode>& binary,
+        const std::vector<uint32_t>& order,
+        int width
+    );
+
+    // обходить нечего: нет объектов или узлов (пустое дерево не обходится)
+    bool empty() const { return objects.empty() || (nodes4.empty() && nodes8.empty()); }
+
+    int                          node_width = 4;
+    SimdLevel                    simd       = SimdLevel::Scalar;
+    std::vector<WideBVHNode<4>>  nodes4;
+    std::vector<WideBVHNode<8>>  nodes8;
+    PrimitiveStore               primitives;   // геометрия в порядке листьев
+    std::vector<HittablePtr>     objects;      // владение объектами
+    AABB                         box;
+    int                          nesting = 0;  // наибольшая вложенность экземпляров
+};
@@ -10,29 +10,42 @@
 class WoodTexture : public Texture {
 public:
     std::shared_ptr<Texture> light, dark;
-    double                   scale;
-    double                   bump_strength;
+    Real                     scale;
+    Real                     bump_strength;
     Perlin                   perlin;
 
     // sc       – масштаб колец,
     // lightTex – светлые волокна, darkTex – тёмные,
     // bumpStr  – сила bump-mapping
 
-    WoodTexture(double sc,
+    WoodTexture(Real sc,
                 std::shared_ptr<Texture> lightTex,
                 std::shared_ptr<Texture> darkTex,
-                double bumpStr = 0.1)
+                Real bumpStr = 0.1)
       : light(std::move(lightTex))
       , dark(std::move(darkTex))
       , scale(sc)
       , bump_strength(bumpStr)
     {}
 
-    virtual Color value(double u, double v, const Vec3& p) const override {
-        double n     = perlin.turb(p * scale, 8) * 0.5;
-        double rings = p.x * scale + 10.0 * n;
-        double sine  = std::sin(rings);
-        double t     = 0.5 * (1.0 + sine);
+    // то же с заданным зерном шума (для загрузки сцены из файла)
+    WoodTexture(Real sc,
+                std::shared_ptr<Texture> lightTex,
+                std::shared_ptr<Texture> darkTex,
+                Real bumpStr,
+                uint64_t perlinSeed)
+      : light(std::move(lightTex))
+      , dark(std::move(darkTex))
+      , scale(sc)
+      , bump_strength(bumpStr)
+      , perlin(perlinSeed)
+    {}
+
+    virtual Color value(Real u, Real v, const Vec3& p) const override {
+        Real n     = perlin.turb(p * scale, 8) * 0.5;
+        Real rings = p.x * scale + 10.0 * n;
+        Real sine  = std::sin(rings);
+        Real t     = 0.5 * (1.0 + sine);
         return light->value(u,v,p) * (1-t)
              + dark->value (u,v,p) *  t;
     }
@@ -2,33 +2,41 @@
 #include <memory>
 #include "Hittable.h"
 #include "AABB.h"
+#include "PrimitiveKernels.h"
 
 class XYRect : public Hittable {
 public:
-    double x0, x1, y0, y1, k;
+    Real x0, x1, y0, y1, k;
     std::shared_ptr<Material> mp;
 
     XYRect() {}
-    XYRect(double _x0, double _x1, double _y0, double _y1, double _k,
+    XYRect(Real _x0, Real _x1, Real _y0, Real _y1, Real _k,
            std::shared_ptr<Material> mat)
       : x0(_x0), x1(_x1), y0(_y0), y1(_y1), k(_k), mp(mat) {}
 
-    virtual bool hit(const Ray& r, double t0, double t1, HitRecord& rec) const override {
-        auto t = (k - r.origin.z) / r.direction.z;
-        if (t < t0 || t > t1) return false;
-        auto x = r.origin.x + t*r.direction.x;
-        auto y = r.origin.y + t*r.direction.y;
-        if (x < x0 || x > x1 || y < y0 || y > y1) return false;
-        rec.u = (x - x0)/(x1 - x0);
-        rec.v = (y - y0)/(y1 - y0);
-        rec.t = t;
-        rec.mat_ptr = mp;
-        rec.p = r.at(t);
-        rec.set_face_normal(r, Vec3(0,0,1));
+    virtual bool intersect(const Ray& r, Real t0, Real t1, Intersection& isect) const override {
+        Real t, x, y;
+        if (!intersect_axis_rect<&Vec3::x, &Vec3::y, &Vec3::z>(x0, x1, y0, y1, k, r, t0, t1, t, x, y))
+            return false;
+        isect.set(t, this, 0, x, y);
         return true;
     }
 
-    virtual bool bounding_box(double, double, AABB& box) const override {
+    virtual void surface(const Ray& r, const Intersection& isect, HitRecord& rec) const override {
+        rec.u = (isect.b0 - x0)/(x1 - x0);
+        rec.v = (isect.b1 - y0)/(y1 - y0);
+        rec.t = isect.t;
+        rec.mat_ptr = mp.get();
+        rec.p = r.at(isect.t);
+        rec.set_face_normal(r, Vec3(0,0,1));
+    }
+
+    virtual bool occluded(const Ray& r, Real t0, Real t1) const override {
+        Real t, x, y;
+        return intersect_axis_rect<&Vec3::x, &Vec3::y, &Vec3::z>(x0, x1, y0, y1, k, r, t0, t1, t, x, y);
+    }
+
+    virtual bool bounding_box(Real, Real, AABB& box) const override {
         // добавить толщину по z
         box = AABB(Point3(x0,y0,k-0.0001), Point3(x1,y1,k+0.0001));
         return true;
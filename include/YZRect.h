@@ -2,33 +2,41 @@
 #include <memory>
 #include "Hittable.h"
 #include "AABB.h"
+#include "PrimitiveKernels.h"
 
 class YZRect : public Hittable {
 public:
-    double y0, y1, z0, z1, k;
+    Real y0, y1, z0, z1, k;
     std::shared_ptr<Material> mp;
 
     YZRect() {}
-    YZRect(double _y0, double _y1, double _z0, double _z1, double _k,
+    YZRect(Real _y0, Real _y1, Real _z0, Real _z1, Real _k,
            std::shared_ptr<Material> mat)
       : y0(_y0), y1(_y1), z0(_z0), z1(_z1), k(_k), mp(mat) {}
 
-    virtual bool hit(const Ray& r, double t0, double t1, HitRecord& rec) const override {
-        auto t = (k - r.origin.x) / r.direction.x;
-        if (t < t0 || t > t1) return false;
-        auto y = r.origin.y + t*r.direction.y;
-        auto z = r.origin.z + t*r.direction.z;
-        if (y < y0 || y > y1 || z < z0 || z > z1) return false;
-        rec.u = (y - y0)/(y1 - y0);
-        rec.v = (z - z0)/(z1 - z0);
-        rec.t = t;
-        rec.mat_ptr = mp;
-        rec.p = r.at(t);
-        rec.set_face_normal(r, Vec3(1,0,0));
+    virtual bool intersect(const Ray& r, Real t0, Real t1, Intersection& isect) const override {
+        Real t, y, z;
+        if (!intersect_axis_rect<&Vec3::y, &Vec3::z, &Vec3::x>(y0, y1, z0, z1, k, r, t0, t1, t, y, z))
+            return false;
+        isect.set(t, this, 0, y, z);
         return true;
     }
 
-    virtual bool bounding_box(double, double, AABB& box) const override {
+    virtual void surface(const Ray& r, const Intersection& isect, HitRecord& rec) const override {
+        rec.u = (isect.b0 - y0)/(y1 - y0);
+        rec.v = (isect.b1 - z0)/(z1 - z0);
+        rec.t = isect.t;
+        rec.mat_ptr = mp.get();
+        rec.p = r.at(isect.t);
+        rec.set_face_normal(r, Vec3(1,0,0));
+    }
+
+    virtual bool occluded(const Ray& r, Real t0, Real t1) const override {
+        Real t, y, z;
+        return intersect_axis_rect<&Vec3::y, &Vec3::z, &Vec3::x>(y0, y1, z0, z1, k, r, t0, t1, t, y, z);
+    }
+
+    virtual bool bounding_box(Real, Real, AABB& box) const override {
         box = AABB(Point3(k-0.0001,y0,z0), Point3(k+0.0001,y1,z1));
         return true;
     }
@@ -1,6 +1,7 @@
 #include "AABB.h"
 #include <algorithm>
 #include <cmath>
+#include <limits>
 
 AABB::AABB() : minimum(Point3(0,0,0)), maximum(Point3(0,0,0)) {}
 AABB::AABB(const Point3& a, const Point3& b) : minimum(a), maximum(b) {}
@@ -8,12 +9,13 @@ AABB::AABB(const Point3& a, const Point3& b) : minimum(a), maximum(b) {}
 Point3 AABB::min() const { return minimum; }
 Point3 AABB::max() const { return maximum; }
 
-bool AABB::hit(const Ray& r, double t_min, double t_max) const {
+bool AABB::hit(const Ray& r, Real t_min, Real t_max) const {
+    const Point3* bounds[2] = { &minimum, &maximum };
     for (int a = 0; a < 3; ++a) {
-        double invD = 1.0 / r.direction[a];
-        double t0   = (minimum[a] - r.origin[a]) * invD;
-        double t1   = (maximum[a] - r.origin[a]) * invD;
-        if (invD < 0.0) std::swap(t0, t1);
+        // ближняя/дальняя грань выбирается по знаку, без деления и swap
+        Real invD = r.inv_direction[a];
+        Real t0   = ((*bounds[r.sign[a]])[a]     - r.origin[a]) * invD;
+        Real t1   = ((*bounds[1 - r.sign[a]])[a] - r.origin[a]) * invD;
         t_min = t0 > t_min ? t0 : t_min;
         t_max = t1 < t_max ? t1 : t_max;
         if (t_max <= t_min)
@@ -35,3 +37,42 @@ AABB AABB::surrounding_box(const AABB& box0, const AABB& box1) {
     );
     return AABB(small, big);
 }
+
+AABB AABB::empty() {
+    const Real inf = std::numeric_limits<Real>::infinity();
+    return AABB(Point3(inf, inf, inf), Point3(-inf, -inf, -inf));
+}
+
+void AABB::expand(const Point3& p) {
+    minimum = Point3(std::fmin(minimum.x, p.x), std::fmin(minimum.y, p.y), std::fmin(minimum.z, p.z));
+    maximum = Point3(std::fmax(maximum.x, p.x), std::fmax(maximum.y, p.y), std::fmax(maximum.z, p.z));
+}
+
+void AABB::expand(const AABB& other) {
+    minimum = Point3(
+        std::fmin(minimum.x, other.minimum.x),
+        std::fmin(minimum.y, other.minimum.y),
+        std::fmin(minimum.z, other.minimum.z)
+    );
+    maximum = Point3(
+        std::fmax(maximum.x, other.maximum.x),
+        std::fmax(maximum.y, other.maximum.y),
+        std::fmax(maximum.z, other.maximum.z)
+    );
+}
+
+Point3 AABB::centroid() const {
+    return 0.5 * (minimum + maximum);
+}
+
+Real AABB::surface_area() const {
+    Vec3 d = maximum - minimum;
+    if (d.x < 0 || d.y < 0 || d.z < 0) return 0.0;
+    return 2.0 * (d.x*d.y + d.y*d.z + d.z*d.x);
+}
+
+int AABB::longest_axis() const {
+    Vec3 d = maximum - minimum;
+    if (d.x > d.y && d.x > d.z) return 0;
+    return d.y > d.z ? 1 : 2;
+}
@@ -1,7 +1,8 @@
 #include "BVH.h"
 #include <algorithm>
-#include <cstdlib>
+#include <cassert>
 #include <iostream>
+#include <limits>
 
 namespace {
     // Вспомогательная функция: сравнить две AABB по координате axis
@@ -18,6 +19,105 @@ namespace {
         }
         return box_a.min()[axis] < box_b.min()[axis];
     }
+
+    // Корзина SAH: объединённая коробка и число попавших в неё примитивов
+    struct SAHBin {
+        AABB   box   = AABB::empty();
+        size_t count = 0;
+    };
+
+    // Номер корзины для центра c на оси с началом lo и масштабом scale
+    inline int sah_bin_index(Real c, Real lo, Real scale) {
+        int b = static_cast<int>((c - lo) * scale);
+        return std::min(std::max(b, 0), SAH_BIN_COUNT - 1);
+    }
+}
+
+SAHSplit sah_partition(
+    const std::vector<BVHPrimitiveInfo>& prims,
+    std::vector<size_t>& order,
+    size_t start,
+    size_t end
+) {
+    AABB bounds          = AABB::empty();
+    AABB centroid_bounds = AABB::empty();
+    for (size_t i = start; i < end; ++i) {
+        bounds.expand(prims[order[i]].box);
+        centroid_bounds.expand(prims[order[i]].centroid);
+    }
+
+    Real parent_area = bounds.surface_area();
+    if (parent_area <= 0.0) parent_area = 1.0;
+
+    SAHSplit best;
+    best.cost = std::numeric_limits<Real>::infinity();
+    int    best_bin   = 0;
+    Real   best_lo    = 0.0;
+    Real   best_scale = 0.0;
+
+    for (int axis = 0; axis < 3; ++axis) {
+        Real lo = centroid_bounds.minimum[axis];
+        Real hi = centroid_bounds.maximum[axis];
+        if (!(hi > lo)) continue;
+        Real scale = SAH_BIN_COUNT / (hi - lo);
+
+        SAHBin bins[SAH_BIN_COUNT];
+        for (size_t i = start; i < end; ++i) {
+            const BVHPrimitiveInfo& p = prims[order[i]];
+            SAHBin& bin = bins[sah_bin_index(p.centroid[axis], lo, scale)];
+            bin.box.expand(p.box);
+            ++bin.count;
+        }
+
+        // Проход справа налево: площадь и число примитивов правой части
+        Real   right_area [SAH_BIN_COUNT - 1];
+        size_t right_count[SAH_BIN_COUNT - 1];
+        AABB   acc = AABB::empty();
+        size_t n   = 0;
+        for (int b = SAH_BIN_COUNT - 1; b > 0; --b) {
+            acc.expand(bins[b].box);
+            n += bins[b].count;
+            right_area [b - 1] = acc.surface_area();
+            right_count[b - 1] = n;
+        }
+
+        // Проход слева направо: оценка стоимости каждой границы
+        acc = AABB::empty();
+        n   = 0;
+        for (int b = 0; b < SAH_BIN_COUNT - 1; ++b) {
+            acc.expand(bins[b].box);
+            n += bins[b].count;
+            if (n == 0 || right_count[b] == 0) continue;
+            Real cost = SAH_TRAVERSAL_COST
+                        + SAH_INTERSECT_COST
+                          * (acc.surface_area() * n + right_area[b] * right_count[b])
+                          / parent_area;
+            if (cost < best.cost) {
+                best.cost  = cost;
+                best.axis  = axis;
+                best_bin   = b;
+                best_lo    = lo;
+                best_scale = scale;
+            }
+        }
+    }
+
+    if (best.axis < 0) {
+        // Все центры совпадают — делим пополам, порядок не важен
+        best.mid  = start + (end - start) / 2;
+        best.cost = SAH_TRAVERSAL_COST + SAH_INTERSECT_COST * (end - start);
+        return best;
+    }
+
+    auto it = std::partition(
+        order.begin() + start,
+        order.begin() + end,
+        [&](size_t idx) {
+            Real c = prims[idx].centroid[best.axis];
+            return sah_bin_index(c, best_lo, best_scale) <= best_bin;
+        });
+    best.mid = static_cast<size_t>(it - order.begin());
+    return best;
 }
 
 BVHNode::BVHNode() = default;
@@ -26,41 +126,59 @@ BVHNode::BVHNode(
     const std::vector<HittablePtr>& src_objects,
     size_t start,
     size_t end,
-    double time0,
-    double time1
+    Real time0,
+    Real time1
 ) {
-    // Копируем указатели, чтобы иметь возможность сортировки
-    auto objects = src_objects;
+    // Коробки считаем один раз, дальше переставляются только индексы —
+    // сам массив объектов не копируется ни на одном уровне рекурсии
+    std::vector<BVHPrimitiveInfo> prims(src_objects.size());
+    std::vector<size_t>           order;
+    order.reserve(end - start);
 
-    // Выбираем случайную ось 0=X,1=Y,2=Z
-    int axis = std::rand() % 3;
-    auto comparator = (axis == 0)
-        ? [](const HittablePtr&a,const HittablePtr&b){ return box_compare_axis(a,b,0); }
-        : (axis == 1)
-            ? [](const HittablePtr&a,const HittablePtr&b){ return box_compare_axis(a,b,1); }
-            : [](const HittablePtr&a,const HittablePtr&b){ return box_compare_axis(a,b,2); };
+    for (size_t i = start; i < end; ++i) {
+        AABB b;
+        if (!src_objects[i]->bounding_box(time0, time1, b))
+            std::cerr << "No bounding box in BVHNode constructor.\n";
+        prims[i].box      = b;
+        prims[i].centroid = b.centroid();
+        order.push_back(i);
+    }
+
+    build(src_objects, prims, order, 0, order.size(), time0, time1);
+}
 
+void BVHNode::build(
+    const std::vector<HittablePtr>& objects,
+    const std::vector<BVHPrimitiveInfo>& prims,
+    std::vector<size_t>& order,
+    size_t start,
+    size_t end,
+    Real time0,
+    Real time1
+) {
     size_t object_span = end - start;
+    Real left_cost   = SAH_INTERSECT_COST;
+    Real right_cost  = SAH_INTERSECT_COST;
 
     if (object_span == 1) {
-        left  = right = objects[start];
+        left  = right = objects[order[start]];
     }
     else if (object_span == 2) {
-        if (comparator(objects[start], objects[start+1])) {
-            left  = objects[start];
-            right = objects[start+1];
-        } else {
-            left  = objects[start+1];
-            right = objects[start];
-        }
+        left  = objects[order[start]];
+        right = objects[order[start+1]];
     }
     else {
-        std::sort(objects.begin() + start,
-                  objects.begin() + end,
-                  comparator);
-        size_t mid = start + object_span / 2;
-        left  = std::make_shared<BVHNode>(objects, start, mid, time0, time1);
-        right = std::make_shared<BVHNode>(objects, mid,   end, time0, time1);
+        SAHSplit split = sah_partition(prims, order, start, end);
+
+        auto left_node  = std::make_shared<BVHNode>();
+        auto right_node = std::make_shared<BVHNode>();
+        left_node ->build(objects, prims, order, start,     split.mid, time0, time1);
+        right_node->build(objects, prims, order, split.mid, end,       time0, time1);
+
+        left_cost  = left_node->cost;
+        right_cost = right_node->cost;
+        left       = left_node;
+        right      = right_node;
     }
 
     AABB box_left, box_right;
@@ -71,36 +189,65 @@ BVHNode::BVHNode(
     }
 
     box = AABB::surrounding_box(box_left, box_right);
+    nesting = std::max(left->instance_nesting(), right->instance_nesting());
+
+    // SAH: цена узла = обход + цена детей, взвешенная вероятностью попадания
+    Real area = box.surface_area();
+    cost = SAH_TRAVERSAL_COST;
+    if (area > 0.0)
+        cost += (box_left.surface_area() * left_cost
+               + box_right.surface_area() * right_cost) / area;
+    else
+        cost += left_cost + right_cost;
 }
 
-bool BVHNode::hit(
+bool BVHNode::intersect(
     const Ray& r,
-    double t_min,
-    double t_max,
-    HitRecord& rec
+    Real t_min,
+    Real t_max,
+    Intersection& isect
 ) const {
     if (!box.hit(r, t_min, t_max))
         return false;
 
-    bool hit_left  = left->hit(r, t_min, t_max, rec);
-    bool hit_right = right->hit(
+    bool hit_left  = left->intersect(r, t_min, t_max, isect);
+    bool hit_right = right->intersect(
         r,
         t_min,
-        hit_left ? rec.t : t_max,
-        rec
+        hit_left ? isect.t : t_max,
+        isect
     );
     return hit_left || hit_right;
 }
 
+void BVHNode::surface(const Ray&, const Intersection&, HitRecord&) const {
+    assert(false && "BVHNode::surface: aggregates never own an intersection");
+}
+
+bool BVHNode::occluded(
+    const Ray& r,
+    Real t_min,
+    Real t_max
+) const {
+    if (!box.hit(r, t_min, t_max))
+        return false;
+    return left->occluded(r, t_min, t_max)
+        || right->occluded(r, t_min, t_max);
+}
+
 bool BVHNode::bounding_box(
-    double time0,
-    double time1,
+    Real time0,
+    Real time1,
     AABB& output_box
 ) const {
     output_box = box;
     return true;
 }
 
+Real BVHNode::sah_cost() const {
+    return cost;
+}
+
 // Определяем свободные функции-компараторы
 bool box_x_compare(const HittablePtr a, const HittablePtr b) {
     return box_compare_axis(a, b, 0);
@@ -1,24 +1,84 @@
 #include "Box.h"
-#include <memory>
-
-#include "XYRect.h"
-#include "XZRect.h"
-#include "YZRect.h"
-#include "HittableList.h"
-
-bool Box::hit(const Ray& r, double t_min, double t_max, HitRecord& rec) const {
-    HittableList sides;
-    sides.add(std::make_shared<XYRect>(
-      box_min.x, box_max.x, box_min.y, box_max.y, box_max.z, mat_ptr));
-    sides.add(std::make_shared<XYRect>(
-      box_min.x, box_max.x, box_min.y, box_max.y, box_min.z, mat_ptr));
-    sides.add(std::make_shared<XZRect>(
-      box_min.x, box_max.x, box_min.z, box_max.z, box_max.y, mat_ptr));
-    sides.add(std::make_shared<XZRect>(
-      box_min.x, box_max.x, box_min.z, box_max.z, box_min.y, mat_ptr));
-    sides.add(std::make_shared<YZRect>(
-      box_min.y, box_max.y, box_min.z, box_max.z, box_max.x, mat_ptr));
-    sides.add(std::make_shared<YZRect>(
-      box_min.y, box_max.y, box_min.z, box_max.z, box_min.x, mat_ptr));
-    return sides.hit(r, t_min, t_max, rec);
+#include "PrimitiveKernels.h"
+
+Box::Box(const Point3& p0, const Point3& p1, std::shared_ptr<Material> m,
+         Real degrees, const Vec3& axis)
+  : Box(p0, p1, m) {
+    oriented = true;
+    Point3 center = 0.5 * (p0 + p1);
+    orientation = Transform::translate(center)
+                * Transform::rotate(degrees, axis)
+                * Transform::translate(-center);
+}
+
+Ray Box::local_ray(const Ray& r) const {
+    return Ray(orientation.inverse_point(r.origin), orientation.inverse_vector(r.direction));
+}
+
+bool Box::slab(const Ray& local, Real t_min, Real t_max,
+               Real& t_hit, int& axis, bool& exit) const {
+    const Real lo[3] = { box_min.x, box_min.y, box_min.z };
+    const Real hi[3] = { box_max.x, box_max.y, box_max.z };
+    return intersect_box_slab(lo, hi, local, t_min, t_max, t_hit, axis, exit);
+}
+
+bool Box::intersect(const Ray& r, Real t_min, Real t_max, Intersection& isect) const {
+    // повёрнутая коробка: поворот сохраняет длины, поэтому t общий
+    Real t;
+    int axis;
+    bool exit;
+    bool found = oriented
+        ? slab(local_ray(r), t_min, t_max, t, axis, exit)
+        : slab(r, t_min, t_max, t, axis, exit);
+    if (!found)
+        return false;
+    isect.set(t, this, box_face_id(axis, exit));
+    return true;
+}
+
+void Box::surface(const Ray& r, const Intersection& isect, HitRecord& rec) const {
+    Ray rotated;
+    const Ray* lr = &r;
+    if (oriented) {
+        rotated = local_ray(r);
+        lr = &rotated;
+    }
+    const Ray& local = *lr;
+    int  axis = int(isect.prim & 3u);
+    bool exit = (isect.prim & 4u) != 0;
+    Real t    = isect.t;
+
+    // наружная нормаль грани: на входе против луча, на выходе по лучу
+    Vec3 outward(0, 0, 0);
+    bool positive = (local.sign[axis] == 0) == exit;
+    outward[axis] = positive ? 1.0 : -1.0;
+
+    // UV как у прямоугольников-граней: две оставшиеся оси по порядку
+    int ua = axis == 0 ? 1 : 0;
+    int va = axis == 2 ? 1 : 2;
+    Point3 lp = local.at(t);
+    rec.u = (lp[ua] - box_min[ua]) / (box_max[ua] - box_min[ua]);
+    rec.v = (lp[va] - box_min[va]) / (box_max[va] - box_min[va]);
+
+    rec.t = t;
+    rec.p = r.at(t);
+    rec.mat_ptr = mat_ptr.get();
+    rec.set_face_normal(r, oriented ? orientation.normal(outward) : outward);
+}
+
+bool Box::occluded(const Ray& r, Real t_min, Real t_max) const {
+    // Коробка сплошная: её поверхность луч пересекает на входе или на выходе
+    Real t;
+    int axis;
+    bool exit;
+    if (!oriented)
+        return slab(r, t_min, t_max, t, axis, exit);
+    return slab(local_ray(r), t_min, t_max, t, axis, exit);
+}
+
+bool Box::bounding_box(Real, Real, AABB& output_box) const {
+    output_box = AABB(box_min, box_max);
+    if (oriented)
+        output_box = orientation.box(output_box);
+    return true;
 }
@@ -1,29 +1,20 @@
 #include "Camera.h"
+#include "Sampler.h"
 #include <cmath>
-#include <random>
-
-namespace {
-    static thread_local std::mt19937 gen(std::random_device{}());
-
-    inline double random_double(double min, double max) {
-        std::uniform_real_distribution<double> dist(min, max);
-        return dist(gen);
-    }
-}
 
 Camera::Camera(
     Point3 lookfrom,
     Point3 lookat,
     Vec3   vup,
-    double vfov,
-    double aspect,
-    double aperture,
-    double focus_dist
+    Real   vfov,
+    Real   aspect,
+    Real   aperture,
+    Real   focus_dist
 ) {
-    double theta = degrees_to_radians(vfov);
-    double h     = std::tan(theta / 2.0);
-    double viewport_height = 2.0 * h;
-    double viewport_width  = aspect * viewport_height;
+    Real theta = degrees_to_radians(vfov);
+    Real h     = std::tan(theta / 2.0);
+    Real viewport_height = 2.0 * h;
+    Real viewport_width  = aspect * viewport_height;
 
     w = unit_vector(lookfrom - lookat);
     u = unit_vector(cross(vup, w));
@@ -40,8 +31,13 @@ Camera::Camera(
     lens_radius = aperture / 2.0;
 }
 
-Ray Camera::get_ray(double s, double t) const {
-    Vec3 rd     = lens_radius * random_in_unit_disk();
+Ray Camera::get_ray(Real s, Real t) const {
+    return get_ray(s, t, sample_2d());
+}
+
+Ray Camera::get_ray(Real s, Real t, const Sample2D& lens) const {
+    // точка на линзе — концентрическое отображение 2D-пробы
+    Vec3 rd     = lens_radius * sample_unit_disk_concentric(lens);
     Vec3 offset = u * rd.x + v * rd.y;
     return Ray(
         origin + offset,
@@ -53,16 +49,14 @@ Ray Camera::get_ray(double s, double t) const {
     );
 }
 
-double Camera::degrees_to_radians(double degrees) {
-    return degrees * M_PI / 180.0;
+void Camera::get_rays(const CameraSample* samples, int count, RayPacket& packet) const {
+    packet.count = 0;
+    for (int k = 0; k < count; ++k) {
+        Ray r = get_ray(samples[k].s, samples[k].t, samples[k].lens);
+        packet.add(r, surface_t_min(r), REAL_INFINITY);
+    }
 }
 
-Vec3 Camera::random_in_unit_disk() {
-    while (true) {
-        double x = random_double(-1.0, 1.0);
-        double y = random_double(-1.0, 1.0);
-        Vec3 p(x, y, 0.0);
-        if (p.length_squared() >= 1.0) continue;
-        return p;
-    }
+Real Camera::degrees_to_radians(Real degrees) {
+    return degrees * M_PI / 180.0;
 }
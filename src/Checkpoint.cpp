@@ -0,0 +1,181 @@
+#include "Checkpoint.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#include <io.h>
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+    // Формат файла (порядок байт — машинный, проверяется по magic):
+    //   char[4] "RTCK", u32 версия, u32 ширина, u32 высота,
+    //   u32 тип сэмплера, u32 номер кадра, u32 spp сэмплера,
+    //   далее на пиксель: 3×f64 сумма, i32 число проб, f64 mean, f64 m2
+    const char     MAGIC[4]    = { 'R', 'T', 'C', 'K' };
+    const uint32_t VERSION     = 2;
+    const size_t   HEADER_SIZE = sizeof(MAGIC) + 6 * sizeof(uint32_t);
+    const size_t   RECORD_SIZE = 3 * sizeof(double) + sizeof(int32_t) + 2 * sizeof(double);
+    const int      BLOCK_ROWS  = 16;   // строк на блок записи/чтения
+
+    template <typename T>
+    void put(char*& p, T value) {
+        std::memcpy(p, &value, sizeof(T));
+        p += sizeof(T);
+    }
+
+    template <typename T>
+    T get(const char*& p) {
+        T value;
+        std::memcpy(&value, p, sizeof(T));
+        p += sizeof(T);
+        return value;
+    }
+
+    // данные файла — на диск до переименования, иначе после сбоя питания
+    // новое имя может указывать на пустой файл
+    bool flush_to_disk(std::FILE* f) {
+        if (std::fflush(f) != 0) return false;
+#ifdef _WIN32
+        return _commit(_fileno(f)) == 0;
+#else
+        return fsync(fileno(f)) == 0;
+#endif
+    }
+
+    // атомарная замена: прежняя контрольная точка остаётся, пока новая не на месте
+    bool replace_file(const std::string& from, const std::string& to) {
+#ifdef _WIN32
+        return MoveFileExA(from.c_str(), to.c_str(),
+                           MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+        return std::rename(from.c_str(), to.c_str()) == 0;
+#endif
+    }
+}
+
+AccumulationBuffer::AccumulationBuffer(int width, int height)
+    : width(width), height(height), pixels(size_t(width) * height)
+{}
+
+void AccumulationBuffer::store_tile(int x0, int y0, int w, int h, const PixelAccum* src) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (int r = 0; r < h; ++r)
+        std::copy_n(src + size_t(r) * w, w, &pixels[size_t(y0 + r) * width + x0]);
+}
+
+bool AccumulationBuffer::save(const std::string& path, const CheckpointInfo& info) const {
+    // прерванная запись не должна портить предыдущую контрольную точку
+    const std::string tmp = path + ".tmp";
+    std::FILE* f = std::fopen(tmp.c_str(), "wb");
+    if (!f) return false;
+
+    char header[HEADER_SIZE];
+    char* p = header;
+    std::memcpy(p, MAGIC, sizeof(MAGIC));
+    p += sizeof(MAGIC);
+    put<uint32_t>(p, VERSION);
+    put<uint32_t>(p, static_cast<uint32_t>(info.width));
+    put<uint32_t>(p, static_cast<uint32_t>(info.height));
+    put<uint32_t>(p, static_cast<uint32_t>(info.sampler_type));
+    put<uint32_t>(p, info.frame_index);
+    put<uint32_t>(p, static_cast<uint32_t>(info.samples_per_pixel));
+    bool ok = std::fwrite(header, 1, HEADER_SIZE, f) == HEADER_SIZE;
+
+    // блоками строк: сериализуем блок под блокировкой, пишем уже без неё
+    std::vector<char> block(size_t(BLOCK_ROWS) * width * RECORD_SIZE);
+    for (int y0 = 0; ok && y0 < height; y0 += BLOCK_ROWS) {
+        const size_t first = size_t(y0) * width;
+        const size_t count = size_t(std::min(BLOCK_ROWS, height - y0)) * width;
+        char* q = block.data();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (size_t k = first; k < first + count; ++k) {
+                const PixelAccum& a = pixels[k];
+                put<double>(q, a.sum.x);
+                put<double>(q, a.sum.y);
+                put<double>(q, a.sum.z);
+                put<int32_t>(q, a.stats.count);
+                put<double>(q, a.stats.mean);
+                put<double>(q, a.stats.m2);
+            }
+        }
+        ok = std::fwrite(block.data(), RECORD_SIZE, count, f) == count;
+    }
+    ok = ok && flush_to_disk(f);
+    ok = std::fclose(f) == 0 && ok;
+    if (!ok) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return replace_file(tmp, path);
+}
+
+bool AccumulationBuffer::load(const std::string& path, const CheckpointInfo& info, std::string& error) {
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) {
+        error = "cannot open " + path;
+        return false;
+    }
+    struct Closer { std::FILE* f; ~Closer() { std::fclose(f); } } closer{ f };
+
+    char header[HEADER_SIZE];
+    if (std::fread(header, 1, HEADER_SIZE, f) != HEADER_SIZE
+        || std::memcmp(header, MAGIC, sizeof(MAGIC)) != 0) {
+        error = path + " is not a checkpoint";
+        return false;
+    }
+    const char* p = header + sizeof(MAGIC);
+    uint32_t version = get<uint32_t>(p);
+    uint32_t w       = get<uint32_t>(p);
+    uint32_t h       = get<uint32_t>(p);
+    uint32_t sampler = get<uint32_t>(p);
+    uint32_t frame   = get<uint32_t>(p);
+    uint32_t spp     = get<uint32_t>(p);
+    if (version != VERSION) {
+        error = "unsupported checkpoint version " + std::to_string(version);
+        return false;
+    }
+    if (int(w) != info.width || int(h) != info.height
+        || sampler != static_cast<uint32_t>(info.sampler_type) || frame != info.frame_index) {
+        error = "checkpoint was made with different image size, sampler or frame";
+        return false;
+    }
+    // страты Stratified строятся под spp: с другим N продолжение дало бы
+    // другую раскладку проб, а не добавило бы пробы к прежней
+    if (info.sampler_type == SamplerType::Stratified && int(spp) != info.samples_per_pixel) {
+        error = "checkpoint was made with " + std::to_string(spp)
+              + " spp; the stratified sampler cannot change spp on resume";
+        return false;
+    }
+
+    std::vector<char> block(size_t(BLOCK_ROWS) * width * RECORD_SIZE);
+    for (int y0 = 0; y0 < height; y0 += BLOCK_ROWS) {
+        const size_t first = size_t(y0) * width;
+        const size_t count = size_t(std::min(BLOCK_ROWS, height - y0)) * width;
+        if (std::fread(block.data(), RECORD_SIZE, count, f) != count) {
+            error = path + " is truncated";
+            return false;
+        }
+        const char* q = block.data();
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t k = first; k < first + count; ++k) {
+            PixelAccum& a = pixels[k];
+            a.sum.x       = get<double>(q);
+            a.sum.y       = get<double>(q);
+            a.sum.z       = get<double>(q);
+            a.stats.count = get<int32_t>(q);
+            a.stats.mean  = get<double>(q);
+            a.stats.m2    = get<double>(q);
+        }
+    }
+    if (std::fgetc(f) != EOF) {
+        error = path + " has trailing data";
+        return false;
+    }
+    return true;
+}
@@ -1,4 +1,5 @@
 #include "HittableList.h"
+#include <cassert>
 #include <utility>
 
 HittableList::HittableList() = default;
@@ -15,30 +16,45 @@ void HittableList::add(HittablePtr object) {
     objects.push_back(std::move(object));
 }
 
-bool HittableList::hit(
+bool HittableList::intersect(
     const Ray& r,
-    double t_min,
-    double t_max,
-    HitRecord& rec
+    Real t_min,
+    Real t_max,
+    Intersection& isect
 ) const {
-    HitRecord temp_rec;
     bool hit_anything = false;
-    double closest_so_far = t_max;
+    Real closest_so_far = t_max;
 
+    // isect меняется только при более близком попадании — копия не нужна
     for (const auto& object : objects) {
-        if (object->hit(r, t_min, closest_so_far, temp_rec)) {
+        if (object->intersect(r, t_min, closest_so_far, isect)) {
             hit_anything   = true;
-            closest_so_far = temp_rec.t;
-            rec            = temp_rec;
+            closest_so_far = isect.t;
         }
     }
 
     return hit_anything;
 }
 
+void HittableList::surface(const Ray&, const Intersection&, HitRecord&) const {
+    assert(false && "HittableList::surface: aggregates never own an intersection");
+}
+
+bool HittableList::occluded(
+    const Ray& r,
+    Real t_min,
+    Real t_max
+) const {
+    for (const auto& object : objects) {
+        if (object->occluded(r, t_min, t_max))
+            return true;
+    }
+    return false;
+}
+
 bool HittableList::bounding_box(
-    double time0,
-    double time1,
+    Real time0,
+    Real time1,
     AABB& output_box
 ) const {
     if (objects.empty()) return false;
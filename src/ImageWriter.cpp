@@ -0,0 +1,376 @@
+#include "ImageWriter.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define RT_IMAGE_WRITER_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+    // Каналы пикселей подряд как массив double. Если Color — ровно три
+    // double, буфер читается на месте; с четвёртой дорожкой (RT_VEC3_SIMD4)
+    // или во float (RT_REAL_FLOAT) каналы сначала собираются в packed
+    template <typename Pixel>
+    const double* flat_channels(const Pixel* pixels, size_t count, std::vector<double>& packed) {
+        if constexpr (std::is_same_v<decltype(Pixel::x), double> && sizeof(Pixel) == 3 * sizeof(double)) {
+            return &pixels->x;
+        } else {
+            packed.resize(count * 3);
+            for (size_t k = 0; k < count; ++k) {
+                packed[3*k + 0] = pixels[k].x;
+                packed[3*k + 1] = pixels[k].y;
+                packed[3*k + 2] = pixels[k].z;
+            }
+            return packed.data();
+        }
+    }
+
+    // Один канал: sqrt (гамма 2), отсечение в [0, 0.999], умножение на 256.
+    // Сравнение «v > 0» отбрасывает и NaN
+    inline uint8_t quantize_channel(double v) {
+        v = v > 0.0 ? std::sqrt(v) : 0.0;
+        return static_cast<uint8_t>(256.0 * std::min(v, 0.999));
+    }
+
+    void quantize_scalar(const double* in, size_t n, uint8_t* out) {
+        for (size_t k = 0; k < n; ++k)
+            out[k] = quantize_channel(in[k]);
+    }
+
+#ifdef RT_IMAGE_WRITER_X86
+    // Тот же расчёт по 4 канала; max_pd(v, 0) возвращает 0 для NaN
+    __attribute__((target("avx2")))
+    void quantize_avx2(const double* in, size_t n, uint8_t* out) {
+        const __m256d zero  = _mm256_setzero_pd();
+        const __m256d limit = _mm256_set1_pd(0.999);
+        const __m256d scale = _mm256_set1_pd(256.0);
+        size_t k = 0;
+        for (; k + 4 <= n; k += 4) {
+            __m256d v = _mm256_max_pd(_mm256_loadu_pd(in + k), zero);
+            v = _mm256_mul_pd(_mm256_min_pd(_mm256_sqrt_pd(v), limit), scale);
+            __m128i i32 = _mm256_cvttpd_epi32(v);
+            __m128i i8  = _mm_packus_epi16(_mm_packs_epi32(i32, i32), _mm_setzero_si128());
+            uint32_t packed = static_cast<uint32_t>(_mm_cvtsi128_si32(i8));
+            std::memcpy(out + k, &packed, 4);
+        }
+        quantize_scalar(in + k, n - k, out + k);
+    }
+
+    bool has_avx2() {
+        static const bool supported = __builtin_cpu_supports("avx2");
+        return supported;
+    }
+#endif
+
+    bool host_is_little_endian() {
+        const uint16_t probe = 1;
+        return *reinterpret_cast<const uint8_t*>(&probe) == 1;
+    }
+
+    // Заголовок PFM: знак масштаба задаёт порядок байт, минус — little-endian
+    std::string pfm_header(int width, int height) {
+        return "PF\n" + std::to_string(width) + ' ' + std::to_string(height)
+             + (host_is_little_endian() ? "\n-1.0\n" : "\n1.0\n");
+    }
+
+    std::string p6_header(int width, int height) {
+        return "P6\n" + std::to_string(width) + ' ' + std::to_string(height) + "\n255\n";
+    }
+
+    void to_float(const Color* pixels, size_t count, float* out) {
+        std::vector<double> packed;
+        const double* in = flat_channels(pixels, count, packed);
+        for (size_t k = 0; k < count * 3; ++k)
+            out[k] = static_cast<float>(in[k]);
+    }
+
+    bool ends_with(const std::string& s, const char* suffix) {
+        size_t n = std::strlen(suffix);
+        if (s.size() < n) return false;
+        for (size_t k = 0; k < n; ++k)
+            if (std::tolower(static_cast<unsigned char>(s[s.size() - n + k])) != suffix[k])
+                return false;
+        return true;
+    }
+
+    // --- PNG: CRC32, Adler-32 и deflate из stored-блоков ---
+
+    uint32_t crc32_update(uint32_t crc, const uint8_t* data, size_t n) {
+        static const auto table = [] {
+            std::vector<uint32_t> t(256);
+            for (uint32_t k = 0; k < 256; ++k) {
+                uint32_t c = k;
+                for (int b = 0; b < 8; ++b)
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                t[k] = c;
+            }
+            return t;
+        }();
+        crc = ~crc;
+        for (size_t k = 0; k < n; ++k)
+            crc = table[(crc ^ data[k]) & 0xFF] ^ (crc >> 8);
+        return ~crc;
+    }
+
+    uint32_t adler32(const uint8_t* data, size_t n) {
+        const uint32_t MOD = 65521;
+        uint32_t a = 1, b = 0;
+        while (n > 0) {
+            // 5552 — наибольший блок без переполнения 32 бит
+            size_t block = std::min<size_t>(n, 5552);
+            n -= block;
+            while (block--) {
+                a += *data++;
+                b += a;
+            }
+            a %= MOD;
+            b %= MOD;
+        }
+        return (b << 16) | a;
+    }
+
+    void put_be32(std::vector<uint8_t>& v, uint32_t x) {
+        v.push_back(uint8_t(x >> 24));
+        v.push_back(uint8_t(x >> 16));
+        v.push_back(uint8_t(x >> 8));
+        v.push_back(uint8_t(x));
+    }
+
+    void write_png_chunk(std::ofstream& out, const char type[4], const std::vector<uint8_t>& data) {
+        std::vector<uint8_t> head;
+        put_be32(head, static_cast<uint32_t>(data.size()));
+        head.insert(head.end(), type, type + 4);
+        uint32_t crc = crc32_update(0, head.data() + 4, 4);
+        crc = crc32_update(crc, data.data(), data.size());
+        std::vector<uint8_t> tail;
+        put_be32(tail, crc);
+        out.write(reinterpret_cast<const char*>(head.data()), head.size());
+        out.write(reinterpret_cast<const char*>(data.data()), data.size());
+        out.write(reinterpret_cast<const char*>(tail.data()), tail.size());
+    }
+
+    bool write_png(const std::string& path, const uint8_t* rgb, int width, int height) {
+        // сырые строки с байтом фильтра 0 (None)
+        const size_t row_bytes = size_t(width) * 3;
+        std::vector<uint8_t> raw((row_bytes + 1) * height);
+        for (int j = 0; j < height; ++j) {
+            raw[j * (row_bytes + 1)] = 0;
+            std::memcpy(&raw[j * (row_bytes + 1) + 1], rgb + j * row_bytes, row_bytes);
+        }
+
+        // zlib-поток: заголовок, stored-блоки по 65535 байт, Adler-32
+        std::vector<uint8_t> z;
+        z.reserve(raw.size() + raw.size() / 65535 * 5 + 16);
+        z.push_back(0x78);
+        z.push_back(0x01);
+        size_t pos = 0;
+        do {
+            size_t   len   = std::min<size_t>(raw.size() - pos, 65535);
+            bool     last  = pos + len == raw.size();
+            uint16_t nlen  = static_cast<uint16_t>(~len);
+            z.push_back(last ? 1 : 0);
+            z.push_back(uint8_t(len));
+            z.push_back(uint8_t(len >> 8));
+            z.push_back(uint8_t(nlen));
+            z.push_back(uint8_t(nlen >> 8));
+            z.insert(z.end(), raw.begin() + pos, raw.begin() + pos + len);
+            pos += len;
+        } while (pos < raw.size());
+        put_be32(z, adler32(raw.data(), raw.size()));
+
+        std::ofstream out(path, std::ios::binary);
+        if (!out) return false;
+        static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+        out.write(reinterpret_cast<const char*>(signature), 8);
+
+        std::vector<uint8_t> ihdr;
+        put_be32(ihdr, static_cast<uint32_t>(width));
+        put_be32(ihdr, static_cast<uint32_t>(height));
+        ihdr.push_back(8);   // бит на канал
+        ihdr.push_back(2);   // RGB
+        ihdr.push_back(0);   // deflate
+        ihdr.push_back(0);   // адаптивная фильтрация
+        ihdr.push_back(0);   // без чересстрочности
+        write_png_chunk(out, "IHDR", ihdr);
+        write_png_chunk(out, "IDAT", z);
+        write_png_chunk(out, "IEND", {});
+        return static_cast<bool>(out);
+    }
+}
+
+ImageFormat image_format_for_path(const std::string& path) {
+    if (ends_with(path, ".pfm")) return ImageFormat::PFM;
+    if (ends_with(path, ".png")) return ImageFormat::PNG;
+    return ImageFormat::PPM;
+}
+
+void quantize_rgb8(const Color* pixels, size_t count, uint8_t* out) {
+    std::vector<double> packed;
+    const double* in = flat_channels(pixels, count, packed);
+#ifdef RT_IMAGE_WRITER_X86
+    if (has_avx2()) {
+        quantize_avx2(in, count * 3, out);
+        return;
+    }
+#endif
+    quantize_scalar(in, count * 3, out);
+}
+
+bool write_rgb8_image(const std::string& path, const uint8_t* rgb,
+                      int width, int height, ImageFormat format) {
+    switch (format) {
+    case ImageFormat::PNG:
+        return write_png(path, rgb, width, height);
+    case ImageFormat::PPMAscii: {
+        std::ofstream out(path);
+        if (!out) return false;
+        out << "P3\n" << width << ' ' << height << "\n255\n";
+        const size_t n = size_t(width) * height;
+        for (size_t k = 0; k < n; ++k)
+            out << int(rgb[3*k]) << ' ' << int(rgb[3*k + 1]) << ' ' << int(rgb[3*k + 2]) << '\n';
+        return static_cast<bool>(out);
+    }
+    case ImageFormat::PPM: {
+        std::ofstream out(path, std::ios::binary);
+        if (!out) return false;
+        out << p6_header(width, height);
+        out.write(reinterpret_cast<const char*>(rgb), std::streamsize(width) * height * 3);
+        return static_cast<bool>(out);
+    }
+    case ImageFormat::PFM:
+    default:
+        return false;
+    }
+}
+
+bool write_image(const std::string& path, const std::vector<Color>& framebuffer,
+                 int width, int height) {
+    ImageFormat format = image_format_for_path(path);
+
+    if (format == ImageFormat::PFM) {
+        // PFM хранит строки снизу вверх — ровно порядок framebuffer
+        std::ofstream out(path, std::ios::binary);
+        if (!out) return false;
+        out << pfm_header(width, height);
+        std::vector<float> row(size_t(width) * 3);
+        for (int j = 0; j < height; ++j) {
+            to_float(&framebuffer[size_t(j) * width], width, row.data());
+            out.write(reinterpret_cast<const char*>(row.data()), row.size() * sizeof(float));
+        }
+        return static_cast<bool>(out);
+    }
+
+    std::vector<uint8_t> rgb(size_t(width) * height * 3);
+    for (int j = 0; j < height; ++j)
+        quantize_rgb8(&framebuffer[size_t(height - 1 - j) * width], width,
+                      &rgb[size_t(j) * width * 3]);
+    return write_rgb8_image(path, rgb.data(), width, height, format);
+}
+
+// --- StreamingImageWriter ---------------------------------------------------
+
+StreamingImageWriter::StreamingImageWriter(const std::string& path, int width, int height)
+    : file_path(path), format(image_format_for_path(path)), width(width), height(height)
+{
+    if (!supports(format)) {
+        failed = true;
+        return;
+    }
+    std::string header = format == ImageFormat::PFM ? pfm_header(width, height)
+                                                    : p6_header(width, height);
+    header_size = header.size();
+    pixel_size  = format == ImageFormat::PFM ? 3 * sizeof(float) : 3;
+    const uint64_t file_size = header_size + uint64_t(width) * height * pixel_size;
+
+#ifdef _WIN32
+    fd = _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+    bool sized = fd >= 0 && _chsize_s(fd, static_cast<__int64>(file_size)) == 0;
+#else
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    // файл полного размера (разреженный): тайлы дописываются на свои места
+    bool sized = fd >= 0 && ::ftruncate(fd, static_cast<off_t>(file_size)) == 0;
+#endif
+    if (!sized || !write_at(0, header.data(), header.size()))
+        failed = true;
+}
+
+StreamingImageWriter::~StreamingImageWriter() {
+    if (fd < 0) return;
+#ifdef _WIN32
+    _close(fd);
+#else
+    ::close(fd);
+#endif
+}
+
+bool StreamingImageWriter::supports(ImageFormat format) {
+    return format == ImageFormat::PPM || format == ImageFormat::PFM;
+}
+
+bool StreamingImageWriter::ok() const {
+    return fd >= 0 && !failed;
+}
+
+bool StreamingImageWriter::write_at(uint64_t offset, const void* data, size_t size) {
+    const char* p = static_cast<const char*>(data);
+#ifdef _WIN32
+    std::lock_guard<std::mutex> lock(io_mutex);
+    if (_lseeki64(fd, static_cast<__int64>(offset), SEEK_SET) < 0)
+        return false;
+    while (size > 0) {
+        int n = _write(fd, p, static_cast<unsigned>(std::min<size_t>(size, 1u << 30)));
+        if (n <= 0) return false;
+        p += n;
+        size -= n;
+    }
+#else
+    while (size > 0) {
+        ssize_t n = ::pwrite(fd, p, size, static_cast<off_t>(offset));
+        if (n <= 0) return false;
+        p      += n;
+        size   -= n;
+        offset += n;
+    }
+#endif
+    return true;
+}
+
+void StreamingImageWriter::write_tile(int x0, int y0, int w, int h, const Color* pixels) {
+    if (!ok()) return;
+    // строка тайла — непрерывный участок строки файла: одна запись на строку
+    std::vector<uint8_t> row(size_t(w) * pixel_size);
+    for (int r = 0; r < h; ++r) {
+        const int    j   = y0 + r;
+        const Color* src = pixels + size_t(r) * w;
+        uint64_t file_row;
+        if (format == ImageFormat::PFM) {
+            to_float(src, w, reinterpret_cast<float*>(row.data()));
+            file_row = j;                  // PFM: снизу вверх
+        } else {
+            quantize_rgb8(src, w, row.data());
+            file_row = height - 1 - j;     // P6: сверху вниз
+        }
+        uint64_t offset = header_size + (file_row * width + x0) * pixel_size;
+        if (!write_at(offset, row.data(), row.size())) {
+            failed = true;
+            return;
+        }
+    }
+}
@@ -0,0 +1,79 @@
+#include "Instance.h"
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+Instance::Instance(HittablePtr blas_in, const Transform& transform)
+    : blas(std::move(blas_in))
+    , object_to_world(transform)
+{
+    // глубже стек экземпляров в Intersection не вмещает — такой экземпляр
+    // не смог бы вернуть ни одного попадания
+    nesting = 1 + blas->instance_nesting();
+    if (nesting > MAX_INSTANCE_DEPTH)
+        throw std::invalid_argument("Instance nesting " + std::to_string(nesting)
+                                    + " exceeds MAX_INSTANCE_DEPTH = " + std::to_string(MAX_INSTANCE_DEPTH));
+
+    AABB local;
+    has_box = blas->bounding_box(0.0, 1.0, local);
+    if (has_box)
+        world_box = object_to_world.box(local);
+}
+
+Ray Instance::local_ray(const Ray& r) const {
+    return Ray(object_to_world.inverse_point(r.origin),
+               object_to_world.inverse_vector(r.direction));
+}
+
+bool Instance::intersect(
+    const Ray& r,
+    Real t_min,
+    Real t_max,
+    Intersection& isect
+) const {
+    Intersection inner;
+    if (!blas->intersect(local_ray(r), t_min, t_max, inner))
+        return false;
+    // вложенность проверена в конструкторе; защита на случай, если
+    // HittableList внутри blas пополнили экземплярами позже
+    if (inner.instance_depth == MAX_INSTANCE_DEPTH)
+        return false;
+
+    // поверхность досчитает внешний экземпляр: он вернёт луч в пространство объекта
+    isect = inner;
+    isect.instances[isect.instance_depth++] = this;
+    return true;
+}
+
+void Instance::surface(
+    const Ray& r,
+    const Intersection& isect,
+    HitRecord& rec
+) const {
+    Intersection inner = isect;
+    --inner.instance_depth;
+    shade_intersection(local_ray(r), inner, rec);
+
+    // ориентация сохраняется: знак dot(d, n) одинаков в обоих пространствах,
+    // поэтому front_face остаётся верным
+    rec.p      = object_to_world.point(rec.p);
+    rec.normal = unit_vector(object_to_world.normal(rec.normal));
+}
+
+bool Instance::occluded(
+    const Ray& r,
+    Real t_min,
+    Real t_max
+) const {
+    return blas->occluded(local_ray(r), t_min, t_max);
+}
+
+bool Instance::bounding_box(
+    Real time0,
+    Real time1,
+    AABB& output_box
+) const {
+    if (!has_box) return false;
+    output_box = world_box;
+    return true;
+}
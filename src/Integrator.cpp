@@ -0,0 +1,169 @@
+#include "Integrator.h"
+#include "Material.h"
+#include "Sampler.h"
+#include <algorithm>
+#include <limits>
+
+// Фон: вертикальный градиент неба
+Color background(const Ray& r) {
+    Vec3 u = unit_vector(r.direction);
+    Real t = 0.5*(u.y + 1.0);
+    return (1.0 - t)*Color(1.0,1.0,1.0)
+         +         t*Color(0.5,0.7,1.0);
+}
+
+Real ambient_occlusion(const Point3& p, const Vec3& normal, const Hittable& world,
+                       const AOSettings& ao) {
+    int   occluded   = 0;
+    // смещаем точку немного по нормали для исключения самопересечений;
+    // нужен только факт попадания — достаточно any-hit запроса
+    const Point3 origin = offset_ray_origin(p, normal);
+    if (ao.packet_size <= 1) {
+        for (int i = 0; i < ao.samples; ++i) {
+            Ray ao_ray(origin, sample_hemisphere(normal, sample_2d()));
+            if (world.occluded(ao_ray, surface_t_min(ao_ray), ao.max_distance))
+                ++occluded;
+        }
+    } else {
+        // лучи из одной точки — пакетами; пробы берутся в прежнем порядке
+        const int packet_size = std::min(ao.packet_size, RAY_PACKET_MAX);
+        for (int i = 0; i < ao.samples; i += packet_size) {
+            RayPacket packet;
+            for (int k = i; k < std::min(i + packet_size, ao.samples); ++k) {
+                Ray ao_ray(origin, sample_hemisphere(normal, sample_2d()));
+                packet.add(ao_ray, surface_t_min(ao_ray), ao.max_distance);
+            }
+            occluded += __builtin_popcount(world.occluded_packet(packet, packet.all()));
+        }
+    }
+    // чем больше occluded, тем меньше освещённость
+    return 1.0 - Real(occluded) / ao.samples;
+}
+
+namespace {
+    // Рекурсивный интегратор для уже найденного попадания луча r
+    Color shade_recursive(const Ray& r, bool found, const HitRecord& rec,
+                          const Hittable& world, int depth, const AOSettings& ao) {
+        if (!found)
+            return background(r);   // 5) Фон
+
+        // 1) Эмиссия материала (DiffuseLight)
+        Color emitted = rec.mat_ptr->emitted();
+        if (emitted.x>0 || emitted.y>0 || emitted.z>0) {
+            return emitted;
+        }
+
+        // 2) Scatter
+        ScatterRecord srec;
+        if (!rec.mat_ptr->scatter(r, rec, srec)) {
+            return Color(0,0,0);
+        }
+
+        // 3) specular
+        if (srec.is_specular) {
+            return srec.attenuation
+                 * ray_color(srec.specular_ray, world, depth-1, ao);
+        }
+
+        // 4) lambertian (diffuse) — только здесь считаем AO
+        //    и умножаем им только диффузную составляющую
+        Real ao_factor = ambient_occlusion(rec.p, rec.normal, world, ao);
+
+        Color diffuse = srec.attenuation
+                      * ray_color(srec.specular_ray, world, depth-1, ao);
+
+        return emitted + ao_factor * diffuse;
+    }
+
+    // Итеративный путь; первое попадание (found, rec) уже найдено
+    Color trace_path(const Ray& r, bool found, HitRecord rec,
+                     const Hittable& world, const IntegratorSettings& settings) {
+        Color throughput(1,1,1);
+        Ray   ray           = r;
+        bool  ao_done       = false;
+
+        for (int bounce = 0; bounce < settings.max_depth; ++bounce) {
+            if (bounce > 0)
+                found = world.hit(ray, surface_t_min(ray), REAL_INFINITY, rec);
+            if (!found)
+                return throughput * background(ray);
+
+            // 1) Эмиссия завершает путь
+            Color emitted = rec.mat_ptr->emitted();
+            if (emitted.x>0 || emitted.y>0 || emitted.z>0)
+                return throughput * emitted;
+
+            // 2) Scatter
+            ScatterRecord srec;
+            if (!rec.mat_ptr->scatter(ray, rec, srec))
+                return Color(0,0,0);
+            throughput = throughput * srec.attenuation;
+
+            // 3) AO — множитель диффузной вершины
+            if (!srec.is_specular) {
+                bool want_ao = settings.ao_mode == AOMode::EveryBounce
+                            || (settings.ao_mode == AOMode::FirstDiffuse && !ao_done);
+                if (want_ao)
+                    throughput *= ambient_occlusion(rec.p, rec.normal, world, settings.ao);
+                ao_done = true;
+            }
+
+            // 4) Русская рулетка
+            if (bounce + 1 >= settings.rr_depth) {
+                Real p = std::min(std::max({ throughput.x, throughput.y, throughput.z }),
+                                  settings.rr_max_survival);
+                if (p <= 0.0 || sample_1d() >= p)
+                    return Color(0,0,0);
+                throughput /= p;
+            }
+
+            ray = srec.specular_ray;
+        }
+        return Color(0,0,0);
+    }
+}
+
+// Трассировка луча
+Color ray_color(const Ray& r, const Hittable& world, int depth, const AOSettings& ao) {
+    if (depth <= 0)
+        return Color(0,0,0);
+
+    HitRecord rec;
+    bool found = world.hit(r, surface_t_min(r), REAL_INFINITY, rec);
+    return shade_recursive(r, found, rec, world, depth, ao);
+}
+
+Color path_color(const Ray& r, const Hittable& world, const IntegratorSettings& settings) {
+    if (settings.max_depth <= 0)
+        return Color(0,0,0);
+
+    HitRecord rec;
+    bool found = world.hit(r, surface_t_min(r), REAL_INFINITY, rec);
+    return trace_path(r, found, rec, world, settings);
+}
+
+Color integrate(const Ray& r, const Hittable& world, const IntegratorSettings& settings) {
+    switch (settings.type) {
+    case IntegratorType::Path:
+    case IntegratorType::Wavefront:   // один путь — то же, что Path
+        return path_color(r, world, settings);
+    case IntegratorType::Recursive:
+    default:
+        return ray_color(r, world, settings.max_depth, settings.ao);
+    }
+}
+
+Color integrate_hit(const Ray& r, bool found, const HitRecord& rec,
+                    const Hittable& world, const IntegratorSettings& settings) {
+    if (settings.max_depth <= 0)
+        return Color(0,0,0);
+
+    switch (settings.type) {
+    case IntegratorType::Path:
+    case IntegratorType::Wavefront:
+        return trace_path(r, found, rec, world, settings);
+    case IntegratorType::Recursive:
+    default:
+        return shade_recursive(r, found, rec, world, settings.max_depth, settings.ao);
+    }
+}
@@ -0,0 +1,248 @@
+#include "LinearBVH.h"
+#include "ParallelBVH.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+
+namespace {
+    // Округление Real -> float наружу, чтобы коробка не сжималась
+    inline float round_down(Real v) {
+        float f = static_cast<float>(v);
+        return f > v ? std::nextafter(f, -std::numeric_limits<float>::infinity()) : f;
+    }
+
+    inline float round_up(Real v) {
+        float f = static_cast<float>(v);
+        return f < v ? std::nextafter(f, std::numeric_limits<float>::infinity()) : f;
+    }
+
+    Real node_area(const LinearBVHNode& node) {
+        Real dx = node.bounds_max[0] - node.bounds_min[0];
+        Real dy = node.bounds_max[1] - node.bounds_min[1];
+        Real dz = node.bounds_max[2] - node.bounds_min[2];
+        return 2.0 * (dx*dy + dy*dz + dz*dx);
+    }
+
+    // Рекурсивное построение сверху вниз; дети узла выделяются парой
+    struct LinearBuilder {
+        const std::vector<BVHPrimitiveInfo>& prims;
+        std::vector<size_t>&                 order;
+        std::vector<LinearBVHNode>&          nodes;
+        int                                  max_leaf;
+
+        void build(uint32_t node_index, size_t start, size_t end, int depth) {
+            AABB bounds = AABB::empty();
+            for (size_t i = start; i < end; ++i)
+                bounds.expand(prims[order[i]].box);
+            nodes[node_index].set_bounds(bounds);
+
+            size_t count = end - start;
+            bool   leaf  = count == 1 || depth >= LINEAR_BVH_MAX_DEPTH - 1;
+
+            SAHSplit split;
+            if (!leaf) {
+                split = sah_partition(prims, order, start, end);
+                // маленький диапазон оставляем листом, если разбиение не окупается
+                leaf = count <= static_cast<size_t>(max_leaf)
+                    && split.cost >= SAH_INTERSECT_COST * count;
+            }
+
+            if (leaf) {
+                nodes[node_index].left_first = static_cast<uint32_t>(start);
+                nodes[node_index].count      = static_cast<uint32_t>(count);
+                return;
+            }
+
+            uint32_t left = static_cast<uint32_t>(nodes.size());
+            nodes.resize(nodes.size() + 2);
+            nodes[node_index].left_first = left;
+            nodes[node_index].count      = 0;
+
+            build(left,     start,     split.mid, depth + 1);
+            build(left + 1, split.mid, end,       depth + 1);
+        }
+    };
+}
+
+void LinearBVHNode::set_bounds(const AABB& b) {
+    for (int a = 0; a < 3; ++a) {
+        bounds_min[a] = round_down(b.minimum[a]);
+        bounds_max[a] = round_up(b.maximum[a]);
+    }
+}
+
+void build_linear_bvh(
+    const std::vector<BVHPrimitiveInfo>& prims,
+    int max_leaf,
+    std::vector<LinearBVHNode>& nodes,
+    std::vector<uint32_t>& order
+) {
+    nodes.clear();
+    order.clear();
+    if (prims.empty()) return;
+
+    std::vector<size_t> indices(prims.size());
+    for (size_t i = 0; i < indices.size(); ++i) indices[i] = i;
+
+    nodes.reserve(2 * prims.size());
+    nodes.resize(1);
+    LinearBuilder builder{ prims, indices, nodes, max_leaf < 1 ? 1 : max_leaf };
+    builder.build(0, 0, indices.size(), 0);
+    nodes.shrink_to_fit();
+
+    order.assign(indices.begin(), indices.end());
+}
+
+Real linear_bvh_sah_cost(const std::vector<LinearBVHNode>& nodes) {
+    if (nodes.empty()) return 0.0;
+
+    // Дети всегда лежат правее родителя — идём с конца массива
+    std::vector<Real> cost(nodes.size());
+    for (size_t i = nodes.size(); i-- > 0; ) {
+        const LinearBVHNode& node = nodes[i];
+        if (node.is_leaf()) {
+            cost[i] = SAH_INTERSECT_COST * node.count;
+            continue;
+        }
+        uint32_t l = node.left_first;
+        Real area = node_area(node);
+        cost[i] = SAH_TRAVERSAL_COST;
+        if (area > 0.0)
+            cost[i] += (node_area(nodes[l]) * cost[l]
+                      + node_area(nodes[l + 1]) * cost[l + 1]) / area;
+        else
+            cost[i] += cost[l] + cost[l + 1];
+    }
+    return cost[0];
+}
+
+void group_leaves_by_kind(
+    const std::vector<LinearBVHNode>& nodes,
+    const std::vector<HittablePtr>& objects,
+    std::vector<uint32_t>& order
+) {
+    std::vector<PrimitiveKind> kinds(objects.size());
+    for (size_t i = 0; i < objects.size(); ++i)
+        kinds[i] = primitive_kind(objects[i].get());
+
+    for (const LinearBVHNode& node : nodes) {
+        if (!node.is_leaf() || node.count < 2)
+            continue;
+        auto first = order.begin() + node.left_first;
+        std::stable_sort(first, first + node.count, [&](uint32_t a, uint32_t b) {
+            return kinds[a] < kinds[b];
+        });
+    }
+}
+
+LinearBVH::LinearBVH(
+    const std::vector<HittablePtr>& src_objects,
+    Real time0,
+    Real time1,
+    int max_leaf_size
+)
+    : objects(src_objects)
+{
+    std::vector<BVHPrimitiveInfo> prims(objects.size());
+    for (size_t i = 0; i < objects.size(); ++i) {
+        AABB b;
+        if (!objects[i]->bounding_box(time0, time1, b))
+            std::cerr << "No bounding box in LinearBVH constructor.\n";
+        prims[i].box      = b;
+        prims[i].centroid = b.centroid();
+    }
+
+    std::vector<uint32_t> order;
+    build_linear_bvh(prims, max_leaf_size, nodes, order);
+    init_primitives(prims, order);
+}
+
+LinearBVH::LinearBVH(
+    const std::vector<HittablePtr>& src_objects,
+    Real time0,
+    Real time1,
+    const ParallelBVHOptions& options
+)
+    : objects(src_objects)
+{
+    // bounding_box() константный — коробки можно считать параллельно
+    std::vector<BVHPrimitiveInfo> prims(objects.size());
+    std::atomic<bool> missing_box{false};
+    parallel_for(objects.size(), options.thread_count, [&](size_t i) {
+        AABB b;
+        if (!objects[i]->bounding_box(time0, time1, b))
+            missing_box = true;
+        prims[i].box      = b;
+        prims[i].centroid = b.centroid();
+    }, 1024);
+    if (missing_box)
+        std::cerr << "No bounding box in LinearBVH constructor.\n";
+
+    std::vector<uint32_t> order;
+    build_linear_bvh_parallel(prims, options, nodes, order);
+    init_primitives(prims, order);
+}
+
+void LinearBVH::init_primitives(
+    const std::vector<BVHPrimitiveInfo>& prims,
+    const std::vector<uint32_t>& order
+) {
+    box = AABB::empty();
+    for (const auto& p : prims)
+        box.expand(p.box);
+
+    std::vector<uint32_t> leaf_order = order;
+    group_leaves_by_kind(nodes, objects, leaf_order);
+    primitives.build(objects, leaf_order);
+    nesting = max_instance_nesting(objects);
+}
+
+bool LinearBVH::intersect(
+    const Ray& r,
+    Real t_min,
+    Real t_max,
+    Intersection& isect
+) const {
+    if (nodes.empty())
+        return false;
+
+    return traverse_linear_bvh(nodes.data(), r, t_min, t_max,
+        [&](uint32_t first, uint32_t count, Real& closest) {
+            return primitives.intersect(first, count, r, t_min, closest, isect);
+        });
+}
+
+void LinearBVH::surface(const Ray&, const Intersection&, HitRecord&) const {
+    assert(false && "LinearBVH::surface: aggregates never own an intersection");
+}
+
+bool LinearBVH::occluded(
+    const Ray& r,
+    Real t_min,
+    Real t_max
+) const {
+    if (nodes.empty())
+        return false;
+
+    return traverse_linear_bvh<true>(nodes.data(), r, t_min, t_max,
+        [&](uint32_t first, uint32_t count, Real&) {
+            return primitives.occluded(first, count, r, t_min, t_max);
+        });
+}
+
+bool LinearBVH::bounding_box(
+    Real time0,
+    Real time1,
+    AABB& output_box
+) const {
+    if (objects.empty()) return false;
+    output_box = box;
+    return true;
+}
+
+Real LinearBVH::sah_cost() const {
+    return linear_bvh_sah_cost(nodes);
+}
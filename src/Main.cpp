@@ -8,6 +8,7 @@
 #include <iomanip>
 #include <cmath>
 #include <algorithm>
+#include <limits>
 #include <filesystem>
 using namespace std;
 namespace fs = std::filesystem;
@@ -17,8 +18,23 @@ namespace fs = std::filesystem;
 #include "HittableList.h"
 #include "Sphere.h"
 #include "Box.h"
-#include "Cone.h"
 #include "BVH.h"
+#include "LinearBVH.h"
+#include "ParallelBVH.h"
+#include "WideBVH.h"
+#include "TileScheduler.h"
+#include "AdaptiveSampling.h"
+#include "Integrator.h"
+#include "Wavefront.h"
+#include "Random.h"
+#include "Sampler.h"
+#include "ImageWriter.h"
+#include "Checkpoint.h"
+#include "SceneFile.h"
+#include "TriangleMesh.h"
+#include "ObjLoader.h"
+#include "Instance.h"
+#include "SphereBatch.h"
 #include "Camera.h"
 #include "Material.h"
 #include "Texture.h"
@@ -33,75 +49,157 @@ namespace fs = std::filesystem;
 using namespace std;
 namespace fs = std::filesystem;
 
-static double ambient_occlusion(const Point3& p, const Vec3& normal, const Hittable& world) {
-    const int AO_SAMPLES = 32;          // число проб (можно уменьшить для скорости)
-    int   occluded   = 0;
-    HitRecord tmp;
-    for (int i = 0; i < AO_SAMPLES; ++i) {
-        Vec3 dir = random_in_hemisphere(normal);
-        // смещаем точку немного по нормали для исключения самопересечений
-        Ray ao_ray(p + 1e-4*normal, dir);
-        if (world.hit(ao_ray, 0.001, std::numeric_limits<double>::infinity(), tmp))
-            ++occluded;
+// Карта числа проб на пиксель: синий — min_spp, красный — max_spp
+static void write_spp_heatmap(const std::string& path, const std::vector<int>& spp,
+                              int width, int height, const AdaptiveSettings& adaptive) {
+    std::vector<uint8_t> rgb;
+    rgb.reserve(size_t(width) * height * 3);
+    double range = std::max(1, adaptive.max_spp - adaptive.min_spp);
+    for (int j = height - 1; j >= 0; --j) {
+        for (int i = 0; i < width; ++i) {
+            double t = std::clamp((spp[j * width + i] - adaptive.min_spp) / range, 0.0, 1.0);
+            rgb.push_back(static_cast<uint8_t>(255 * t));
+            rgb.push_back(static_cast<uint8_t>(255 * (1.0 - std::fabs(2.0 * t - 1.0))));
+            rgb.push_back(static_cast<uint8_t>(255 * (1.0 - t)));
+        }
     }
-    // чем больше occluded, тем меньше освещённость
-    return 1.0 - double(occluded) / AO_SAMPLES;
+    write_rgb8_image(path, rgb.data(), width, height, image_format_for_path(path));
 }
 
+// Отчёт: время параллельного построения BVH в зависимости от числа потоков
+static void report_bvh_build_scaling(const vector<HittablePtr>& objs, int max_threads) {
+    std::cout << "BVH build scaling (" << objs.size() << " primitives):\n";
+    for (int n = 1; ; n = std::min(n * 2, max_threads)) {
+        ParallelBVHOptions options;
+        options.thread_count = n;
+        auto start = std::chrono::steady_clock::now();
+        LinearBVH bvh(objs, 0.0, 1.0, options);
+        double ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+        std::cout << "  threads " << std::setw(3) << n << ": "
+                  << std::fixed << std::setprecision(2) << ms << " ms\n";
+        if (n >= max_threads) break;
+    }
+}
 
-// Трассировка луча
-Color ray_color(const Ray& r, const Hittable& world, int depth) {
-    if (depth <= 0)
-        return Color(0,0,0);
-
-    HitRecord rec;
-    if (world.hit(r, 0.001, std::numeric_limits<double>::infinity(), rec)) {
-        // 1) Эмиссия материала (DiffuseLight)
-        Color emitted = rec.mat_ptr->emitted();
-        if (emitted.x>0 || emitted.y>0 || emitted.z>0) {
-            return emitted;
-        }
+// Отчёт: пакетное ядро сфер (SphereBatch.h) против Sphere::hit по одной сфере.
+// Сферы лежат пачками по batch штук, как в листе BVH; время — на один тест сферы
+static void report_sphere_kernels(int batch) {
+    const int sphere_count = 4096 * batch;
+    const int ray_count    = 1024;
+    std::vector<Real> cx(sphere_count), cy(sphere_count), cz(sphere_count), radius(sphere_count);
+    std::vector<HittablePtr> spheres;
+    for (int i = 0; i < sphere_count; ++i) {
+        cx[i] = random_double(-1, 1);
+        cy[i] = random_double(-1, 1);
+        cz[i] = random_double(-1, 1);
+        radius[i] = random_double(0.01, 0.05);
+        spheres.push_back(make_shared<Sphere>(Point3(cx[i], cy[i], cz[i]), radius[i], nullptr));
+    }
+    std::vector<Ray> rays;
+    for (int k = 0; k < ray_count; ++k) {
+        Point3 origin(random_double(-2, 2), random_double(-2, 2), 3.0);
+        Point3 target(random_double(-1, 1), random_double(-1, 1), random_double(-1, 1));
+        rays.emplace_back(origin, target - origin);
+    }
 
-        // 2) Scatter
-        ScatterRecord srec;
-        if (!rec.mat_ptr->scatter(r, rec, srec)) {
-            return Color(0,0,0);
+    auto report = [&](const char* name, auto&& trace) {
+        auto start = std::chrono::steady_clock::now();
+        long hits = 0;
+        for (const Ray& r : rays)
+            hits += trace(r);
+        double ns = std::chrono::duration<double, std::nano>(
+            std::chrono::steady_clock::now() - start).count();
+        std::cout << "  " << std::setw(12) << std::left << name << std::right
+                  << std::fixed << std::setprecision(2)
+                  << ns / (double(ray_count) * sphere_count) << " ns/sphere, "
+                  << hits << " hits\n";
+    };
+
+    std::cout << "Sphere kernels (" << sphere_count << " spheres, batches of " << batch << "):\n";
+    report("Sphere::hit", [&](const Ray& r) {
+        const Real t_min = surface_t_min(r);
+        long hits = 0;
+        for (int i = 0; i < sphere_count; i += batch) {
+            Real     closest = REAL_INFINITY;
+            HitRecord rec;
+            bool     found   = false;
+            for (int j = i; j < i + batch; ++j) {
+                if (spheres[j]->hit(r, t_min, closest, rec)) {
+                    closest = rec.t;
+                    found   = true;
+                }
+            }
+            hits += found;
         }
+        return hits;
+    });
+    const char* names[] = { "scalar", "SSE", "AVX2" };
+    const int   best    = int(detect_simd_level());
+    for (int level = 0; level <= best; ++level) {
+        SphereBatchKernel kernel = sphere_batch_kernel(SimdLevel(level));
+        report(names[level], [&](const Ray& r) {
+            const Real t_min = surface_t_min(r);
+            long hits = 0;
+            for (int i = 0; i < sphere_count; i += batch) {
+                Real     t = REAL_INFINITY;
+                uint32_t index;
+                hits += kernel(&cx[i], &cy[i], &cz[i], &radius[i], batch, r, t_min, t, index);
+            }
+            return hits;
+        });
+    }
+}
 
-        // 3) specular
-        if (srec.is_specular) {
-            return srec.attenuation
-                 * ray_color(srec.specular_ray, world, depth-1);
+// Отчёт: первичные лучи в секунду — генерация луча камерой, ближайшее
+// попадание и рассеяние материала, по лучу на пиксель. Горячий путь почти
+// целиком из операций Vec3, поэтому замер показывает и их стоимость
+static void report_primary_rays(const Camera& cam, const Hittable& world, int width, int height) {
+    auto start = std::chrono::steady_clock::now();
+    long hits = 0;
+    for (int j = 0; j < height; ++j) {
+        for (int i = 0; i < width; ++i) {
+            Ray r = cam.get_ray((i + random_double()) / (width - 1), (j + random_double()) / (height - 1));
+            HitRecord rec;
+            if (!world.hit(r, surface_t_min(r), REAL_INFINITY, rec))
+                continue;
+            ScatterRecord srec;
+            hits += rec.mat_ptr->scatter(r, rec, srec);
         }
-
-        // 4) lambertian (diffuse) — только здесь считаем AO
-        //    и умножаем им только диффузную составляющую
-        double ao = ambient_occlusion(rec.p, rec.normal, world);
-
-        Color diffuse = srec.attenuation
-                      * ray_color(srec.specular_ray, world, depth-1);
-
-        return emitted + ao * diffuse;
     }
-
-    // 5) Фон
-    Vec3 u = unit_vector(r.direction);
-    double t = 0.5*(u.y + 1.0);
-    return (1.0 - t)*Color(1.0,1.0,1.0)
-         +         t*Color(0.5,0.7,1.0);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Primary rays: " << std::fixed << std::setprecision(2)
+              << double(width) * height / seconds * 1e-6 << " Mrays/s, "
+              << hits << " scattered\n" << std::defaultfloat;
 }
 
+// Расставить count экземпляров одной сетки по сетке на полу: все они
+// ссылаются на одно BLAS, в памяти — одна копия геометрии
+static void add_mesh_instances(HittableList& world, const HittablePtr& mesh, int count) {
+    AABB b;
+    mesh->bounding_box(0.0, 1.0, b);
+    Vec3   extent = b.maximum - b.minimum;
+    Real   size   = std::max({ extent.x, extent.y, extent.z, Real(1e-9) });
+    // нижний центр коробки — в начало координат, наибольший размер — 1
+    Transform normalize = Transform::scale(1.0 / size)
+                        * Transform::translate(Vec3(-0.5 * (b.minimum.x + b.maximum.x),
+                                                    -b.minimum.y,
+                                                    -0.5 * (b.minimum.z + b.maximum.z)));
+    const int    side = static_cast<int>(std::ceil(std::sqrt(double(count))));
+    const double cell = 8.0 / side;   // площадка x in [-4, 4], z in [-7, 1]
+    for (int k = 0; k < count; ++k) {
+        int    gx = k % side, gz = k / side;
+        double yaw = 360.0 * (mix64(k) >> 11) * (1.0 / 9007199254740992.0);
+        Transform place = Transform::translate(Vec3(-4.0 + (gx + 0.5) * cell, 0.0, -7.0 + (gz + 0.5) * cell))
+                        * Transform::rotate(yaw, Vec3(0, 1, 0))
+                        * Transform::scale(0.8 * cell)
+                        * normalize;
+        world.add(make_shared<Instance>(mesh, place));
+    }
+}
 
-int main() {
-    // 1) Параметры рендера
-    const double aspect_ratio      = 16.0/9.0;
-    const int    image_width       = 1920;
-    const int    image_height      = static_cast<int>(image_width/aspect_ratio);
-    const int    samples_per_pixel = 500;
-    const int    max_depth         = 50;
-    const int    thread_count      = thread::hardware_concurrency();
-
-
+// Встроенная сцена: материалы и объекты
+static HittableList build_default_scene() {
     // 2) Материалы
     auto mat_ground  = std::make_shared<Lambertian>(
     std::make_shared<ConstantTexture>(Color(0.8,0.8,0.0))
@@ -163,9 +261,127 @@ int main() {
        mat_wood
    ));
 
-    // BVH для ускорения
-    vector<HittablePtr> objs = world.objects;
-    BVHNode bvh(objs, 0, objs.size(), 0.0, 1.0);
+    return world;
+}
+
+int main(int argc, char** argv) {
+    // 0) Аргументы: --checkpoint F — сохранять контрольные точки в F,
+    //    --resume — продолжить рендер из контрольной точки --checkpoint,
+    //    --spp N — другое число проб (с --resume добавляет пробы к готовому кадру)
+    //    --scene F — загрузить сцену и BVH из двоичного файла вместо встроенной,
+    //    --save-scene F — записать встроенную сцену в такой файл,
+    //    --obj F — добавить во встроенную сцену треугольную сетку из OBJ,
+    //    --instances N — вместо одной сетки расставить N её экземпляров,
+    //    --bench — замеры (ядро сфер, построение BVH, первичные лучи) без рендера
+    bool resume  = false;
+    bool bench   = false;
+    int  spp_arg = 0;
+    int  instances_arg = 0;
+    std::string scene_arg, save_scene_arg, obj_arg, checkpoint_arg;
+    for (int a = 1; a < argc; ++a) {
+        std::string arg = argv[a];
+        if (arg == "--resume")
+            resume = true;
+        else if (arg == "--bench")
+            bench = true;
+        else if (arg == "--checkpoint" && a + 1 < argc)
+            checkpoint_arg = argv[++a];
+        else if (arg == "--spp" && a + 1 < argc)
+            spp_arg = std::atoi(argv[++a]);
+        else if (arg == "--scene" && a + 1 < argc)
+            scene_arg = argv[++a];
+        else if (arg == "--save-scene" && a + 1 < argc)
+            save_scene_arg = argv[++a];
+        else if (arg == "--obj" && a + 1 < argc)
+            obj_arg = argv[++a];
+        else if (arg == "--instances" && a + 1 < argc)
+            instances_arg = std::atoi(argv[++a]);
+        else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--checkpoint file.rtck [--resume]] [--spp N] [--scene file.rtsc] [--save-scene file.rtsc]"
+                         " [--obj file.obj [--instances N]] [--bench]\n";
+            return 1;
+        }
+    }
+
+    // 1) Параметры рендера
+    const double aspect_ratio      = 16.0/9.0;
+    const int    image_width       = 1920;
+    const int    image_height      = static_cast<int>(image_width/aspect_ratio);
+    const int    samples_per_pixel = spp_arg > 0 ? spp_arg : 500;
+    const int    thread_count      = thread::hardware_concurrency();
+    const uint32_t frame_index     = 0;      // участвует в зерне генератора
+    const int    tile_size         = 32;
+    const int    packet_size       = 1;      // первичных лучей в пакете: 1 (по одному), 4 (2x2), 8 (4x2) или 16 (4x4)
+    const TileOrder tile_order     = TileOrder::Morton;
+    const SamplerType sampler_type = SamplerType::Sobol;   // Independent — прежний PCG32
+    const std::string output_path     = "output/image.ppm";   // формат по расширению: .ppm (P6), .png, .pfm
+    const std::string output_hdr_path = "";                   // например "output/image.pfm"; пусто — не писать
+    const bool   stream_output     = false;  // писать готовые тайлы сразу в файл (P6/PFM), без кадра в памяти
+    const std::string checkpoint_path = checkpoint_arg;   // --checkpoint; пусто — без контрольных точек
+    const double checkpoint_interval  = 300.0;  // секунд между контрольными точками
+    IntegratorSettings integrator;             // Recursive: исходный ray_color(); Wavefront — волнами по тайлу
+    integrator.max_depth = 50;                 // AO: 32 пробы, max_distance = 2.0
+    AdaptiveSettings adaptive;                 // выключено: ровно samples_per_pixel проб
+    adaptive.max_spp = samples_per_pixel;
+
+
+    // --bench: пакетное ядро сфер против Sphere::hit
+    if (bench) {
+        report_sphere_kernels(4);
+        report_sphere_kernels(8);
+    }
+
+    // 2–3) Сцена и BVH для ускорения: из файла или встроенная
+    ParallelBVHOptions bvh_options;
+    bvh_options.thread_count = thread_count;
+    ParallelBVHOptions mesh_options = bvh_options;   // треугольники проверяются по одному
+    bvh_options.leaf_batch_size = 4;                  // сферы листа — одним пакетным ядром
+    std::unique_ptr<WideBVH> bvh;
+    auto bvh_start = std::chrono::steady_clock::now();
+    if (!scene_arg.empty()) {
+        // готовое BVH из файла: только свёртка в широкое
+        LoadedScene scene;
+        std::string error;
+        if (!load_scene_file(scene_arg, scene, error)) {
+            std::cerr << "Cannot load scene: " << error << "\n";
+            return 1;
+        }
+        bvh = std::make_unique<WideBVH>(scene.objects, scene.bvh_nodes, scene.bvh_order);
+    } else {
+        HittableList world = build_default_scene();
+        if (!obj_arg.empty()) {
+            std::string error;
+            auto mat_mesh = make_shared<Lambertian>(make_shared<ConstantTexture>(Color(0.7,0.7,0.7)));
+            auto mesh = load_obj_mesh(obj_arg, mat_mesh, error, mesh_options);
+            if (!mesh) {
+                std::cerr << "Cannot load mesh: " << error << "\n";
+                return 1;
+            }
+            std::cout << "Mesh " << obj_arg << ": " << mesh->triangle_count() << " triangles, "
+                      << mesh->vertex_count() << " vertices\n";
+            if (instances_arg > 1)
+                add_mesh_instances(world, mesh, instances_arg);
+            else
+                world.add(mesh);
+        }
+        if (!save_scene_arg.empty()) {
+            std::string error;
+            if (write_scene_file(save_scene_arg, world, bvh_options, error))
+                std::cout << "Scene saved to " << save_scene_arg << "\n";
+            else
+                std::cerr << "Cannot save scene: " << error << "\n";
+        }
+        if (bench)   // время построения BVH по числу потоков
+            report_bvh_build_scaling(world.objects, thread_count);
+        bvh = std::make_unique<WideBVH>(world.objects, 0.0, 1.0, bvh_options);
+    }
+    double bvh_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - bvh_start).count();
+    const char* simd_names[] = { "scalar", "SSE", "AVX2" };
+    std::cout << "BVH" << bvh->width() << " (" << simd_names[int(bvh->simd_level())] << "): "
+              << bvh->node_count() << " nodes, "
+              << (scene_arg.empty() ? "built" : "loaded") << " in " << bvh_ms << " ms\n";
 
     // 4) Камера с DOF
     Point3 lookfrom( 0.0, 2.0,  3.0 );
@@ -182,46 +398,240 @@ int main() {
         aperture,
         dist_to_focus
     );
+    if (bench) {
+        // первичные лучи в секунду (камера + попадание + материал); рендер не нужен
+        report_primary_rays(cam, *bvh, image_width, image_height);
+        return 0;
+    }
 
     // 5) Рендер
 
-    std::vector<Color> framebuffer(image_width * image_height);
-    std::atomic<int>   lines_done{0};
+    // Выходные файлы: P6/PFM при stream_output пишутся по тайлам сразу,
+    // остальные — из framebuffer после рендера
+    std::vector<std::string> output_paths = { output_path };
+    if (!output_hdr_path.empty())
+        output_paths.push_back(output_hdr_path);
+    for (const std::string& path : output_paths) {
+        fs::path dir = fs::path(path).parent_path();
+        if (!dir.empty())
+            fs::create_directories(dir);
+    }
+    std::vector<std::unique_ptr<StreamingImageWriter>> streams;
+    std::vector<std::string> deferred_paths;
+    for (const std::string& path : output_paths) {
+        if (stream_output && StreamingImageWriter::supports(image_format_for_path(path)))
+            streams.push_back(std::make_unique<StreamingImageWriter>(path, image_width, image_height));
+        else
+            deferred_paths.push_back(path);
+    }
+    for (const auto& stream : streams)
+        if (!stream->ok())
+            std::cerr << "Failed to open " << stream->path() << "\n";
+
+    std::vector<Color> framebuffer(deferred_paths.empty() ? 0 : size_t(image_width) * image_height);
+
+    // Буфер накопления для контрольных точек; при --resume загружается из файла
+    CheckpointInfo checkpoint_info;
+    checkpoint_info.width        = image_width;
+    checkpoint_info.height       = image_height;
+    checkpoint_info.sampler_type = sampler_type;
+    checkpoint_info.frame_index  = frame_index;
+    checkpoint_info.samples_per_pixel = adaptive.enabled ? adaptive.max_spp : samples_per_pixel;
+    std::unique_ptr<AccumulationBuffer> accum;
+    if (!checkpoint_path.empty()) {
+        fs::path dir = fs::path(checkpoint_path).parent_path();
+        if (!dir.empty())
+            fs::create_directories(dir);
+        accum = std::make_unique<AccumulationBuffer>(image_width, image_height);
+    }
+    if (resume) {
+        std::string error;
+        if (!accum || !accum->load(checkpoint_path, checkpoint_info, error)) {
+            std::cerr << "Cannot resume: " << (accum ? error : "--resume needs --checkpoint file.rtck") << "\n";
+            return 1;
+        }
+        std::cout << "Resuming from " << checkpoint_path << "\n";
+    }
+    std::vector<int>   spp_buffer(adaptive.write_heatmap ? image_width * image_height : 0);
+    std::atomic<long long> total_samples{0};
+    std::atomic<int>   tiles_done{0};
     std::atomic<bool>  render_done{false};
     auto               start_time = std::chrono::steady_clock::now();
 
-    // --- Запуск рендер-потоков ---
-    std::vector<std::thread> threads;
-    for (int t = 0; t < thread_count; ++t) {
-        threads.emplace_back([&, t]() {
-            for (int j = image_height - 1 - t; j >= 0; j -= thread_count) {
-                for (int i = 0; i < image_width; ++i) {
-                    Color col(0,0,0);
-                    for (int s = 0; s < samples_per_pixel; ++s) {
-                        double u = (i + random_double()) / (image_width  - 1);
-                        double v = (j + random_double()) / (image_height - 1);
-                        Ray    r = cam.get_ray(u, v);
-                        col += ray_color(r, bvh, max_depth);
+    // --- Планировщик тайлов с перехватом работы ---
+    TileSchedulerOptions tile_options;
+    tile_options.tile_size    = tile_size;
+    tile_options.order        = tile_order;
+    tile_options.thread_count = thread_count;
+    TileScheduler scheduler(image_width, image_height, tile_options);
+    const int     tile_count = static_cast<int>(scheduler.tiles().size());
+
+    // У каждого потока свой буфер тайла: соседние потоки не пишут
+    // в общие строки кэша framebuffer, пока считают пиксели
+    std::vector<std::vector<Color>> tile_buffers(scheduler.thread_count());
+
+    // Сэмплер хранит текущую пробу и номер измерения — по копии на поток
+    const int spp_limit = adaptive.enabled ? adaptive.max_spp : samples_per_pixel;
+    std::unique_ptr<Sampler> sampler_prototype = make_sampler(sampler_type, spp_limit, frame_index);
+    std::vector<std::unique_ptr<Sampler>> samplers;
+    for (int t = 0; t < scheduler.thread_count(); ++t)
+        samplers.push_back(sampler_prototype->clone());
+
+    // форма блока пикселей под один пакет первичных лучей
+    const int packet_w = packet_size >= 8 ? 4 : packet_size >= 4 ? 2 : 1;
+    const int packet_h = std::clamp(packet_size / packet_w, 1, RAY_PACKET_MAX / packet_w);
+
+    // Рабочие массивы тайла — по набору на поток, переиспользуются между тайлами
+    struct TileWork {
+        std::vector<PixelAccum>     acc;       // набранные пробы пикселей тайла
+        std::vector<int>            order;     // пиксели тайла по блокам
+        std::vector<int>            groups;    // начала групп в order
+        std::vector<CameraSample>   samples;   // очередной раунд: проба камеры,
+        std::vector<Sampler::State> states;    // положение сэмплера после неё
+        std::vector<int>            pixels;    // и пиксель
+        std::vector<Ray>            rays;
+        std::vector<Color>          colors;
+        std::unique_ptr<WavefrontIntegrator> wavefront;
+    };
+    const bool wavefront = integrator.type == IntegratorType::Wavefront;
+    std::vector<TileWork> tile_work(scheduler.thread_count());
+    if (wavefront)
+        for (TileWork& work : tile_work)
+            work.wavefront = std::make_unique<WavefrontIntegrator>(*bvh, integrator, packet_size);
+
+    std::thread render_thread([&]() {
+        scheduler.run([&](const Tile& tile, int worker) {
+            std::vector<Color>& buf = tile_buffers[worker];
+            buf.resize(size_t(tile.width()) * tile.height());
+            long long tile_samples = 0;
+            Sampler&  sampler      = *samplers[worker];
+            thread_sampler()       = &sampler;   // камера, материалы и AO берут пробы отсюда
+            TileWork& work = tile_work[worker];
+            std::vector<PixelAccum>& acc_buf = work.acc;
+            acc_buf.resize(buf.size());
+            // с контрольной точкой продолжаем с уже набранных проб
+            for (int j = tile.y0; j < tile.y1; ++j)
+                for (int i = tile.x0; i < tile.x1; ++i)
+                    acc_buf[(j - tile.y0) * tile.width() + (i - tile.x0)] = accum ? accum->at(i, j) : PixelAccum{};
+
+            // Пиксели тайла идут блоками packet_w x packet_h: первичные лучи
+            // очередной пробы всех ещё не законченных пикселей блока
+            // трассируются одним пакетом, дальше каждый путь считается сам;
+            // при packet_size 1 блок — один пиксель, луч идёт без пакета.
+            // Волновому интегратору весь тайл — одна группа: пробы всех
+            // пикселей идут в очередь путей разом
+            work.order.clear();
+            work.groups.clear();
+            for (int by = 0; by < tile.height(); by += packet_h) {
+                for (int bx = 0; bx < tile.width(); bx += packet_w) {
+                    if (!wavefront || work.groups.empty())
+                        work.groups.push_back(int(work.order.size()));
+                    for (int y = by; y < std::min(by + packet_h, tile.height()); ++y)
+                        for (int x = bx; x < std::min(bx + packet_w, tile.width()); ++x)
+                            work.order.push_back(y * tile.width() + x);
+                }
+            }
+            work.groups.push_back(int(work.order.size()));
+
+            for (size_t g = 0; g + 1 < work.groups.size(); ++g) {
+                while (true) {
+                    work.samples.clear();
+                    work.states.clear();
+                    work.pixels.clear();
+                    for (int o = work.groups[g]; o < work.groups[g + 1]; ++o) {
+                        const int local = work.order[o];
+                        const PixelStats& stats = acc_buf[local].stats;
+                        if (stats.count >= spp_limit
+                            || (adaptive.enabled && stats.count > 0 && stats.converged(adaptive)))
+                            continue;
+                        const int i = tile.x0 + local % tile.width();
+                        const int j = tile.y0 + local / tile.width();
+                        // пробы зависят только от (пиксель, номер пробы, кадр)
+                        sampler.start_pixel_sample(uint64_t(j) * image_width + i, stats.count);
+                        Sample2D     jitter = sampler.get_2d();
+                        CameraSample cs;
+                        cs.s    = (i + jitter.x) / (image_width  - 1);
+                        cs.t    = (j + jitter.y) / (image_height - 1);
+                        cs.lens = sampler.get_2d();
+                        work.samples.push_back(cs);
+                        work.states.push_back(sampler.save_state());
+                        work.pixels.push_back(local);
+                    }
+                    const int n = int(work.samples.size());
+                    if (n == 0)
+                        break;
+
+                    work.colors.resize(n);
+                    if (wavefront) {
+                        work.rays.clear();
+                        for (const CameraSample& cs : work.samples)
+                            work.rays.push_back(cam.get_ray(cs.s, cs.t, cs.lens));
+                        work.wavefront->trace(work.rays.data(), work.states.data(), n,
+                                              sampler, work.colors.data());
+                    } else if (packet_size <= 1) {
+                        for (int k = 0; k < n; ++k) {
+                            const CameraSample& cs = work.samples[k];
+                            Ray r = cam.get_ray(cs.s, cs.t, cs.lens);
+                            sampler.restore_state(work.states[k]);
+                            work.colors[k] = integrate(r, *bvh, integrator);
+                        }
+                    } else {
+                        for (int first = 0; first < n; first += RAY_PACKET_MAX) {
+                            const int count = std::min(RAY_PACKET_MAX, n - first);
+                            RayPacket packet;
+                            HitRecord recs[RAY_PACKET_MAX];
+                            cam.get_rays(&work.samples[first], count, packet);
+                            const uint32_t found = bvh->hit_packet(packet, packet.all(), recs);
+                            for (int k = 0; k < count; ++k) {
+                                // путь продолжает пробу с того измерения, где её оставила камера
+                                sampler.restore_state(work.states[first + k]);
+                                work.colors[first + k] = integrate_hit(packet.rays[k], (found >> k) & 1,
+                                                                       recs[k], *bvh, integrator);
+                            }
+                        }
+                    }
+                    for (int k = 0; k < n; ++k) {
+                        PixelAccum& acc = acc_buf[work.pixels[k]];
+                        acc.sum += work.colors[k];
+                        acc.stats.add(luminance(work.colors[k]));
                     }
-                    // среднее + гамма-коррекция
-                    col /= samples_per_pixel;
-                    col.x = std::sqrt(col.x);
-                    col.y = std::sqrt(col.y);
-                    col.z = std::sqrt(col.z);
+                }
+            }
 
-                    framebuffer[j * image_width + i] = col;
+            for (int j = tile.y0; j < tile.y1; ++j) {
+                for (int i = tile.x0; i < tile.x1; ++i) {
+                    const int         local = (j - tile.y0) * tile.width() + (i - tile.x0);
+                    const Color&      col   = acc_buf[local].sum;
+                    const PixelStats& stats = acc_buf[local].stats;
+                    tile_samples += stats.count;
+                    if (!spp_buffer.empty())
+                        spp_buffer[j * image_width + i] = stats.count;
+
+                    // в кадре — линейное среднее; гамма применяется при записи
+                    buf[local] = stats.count > 0 ? col / stats.count : Color(0,0,0);
                 }
-                ++lines_done;
             }
+
+            // Готовый тайл целиком — в буфер накопления, файлы и/или кадр
+            if (accum)
+                accum->store_tile(tile.x0, tile.y0, tile.width(), tile.height(), acc_buf.data());
+            for (const auto& stream : streams)
+                stream->write_tile(tile.x0, tile.y0, tile.width(), tile.height(), buf.data());
+            if (!framebuffer.empty())
+                for (int j = tile.y0; j < tile.y1; ++j)
+                    std::copy_n(&buf[(j - tile.y0) * tile.width()], tile.width(),
+                                &framebuffer[j * image_width + tile.x0]);
+            total_samples += tile_samples;
+            ++tiles_done;
         });
-    }
+    });
 
     // --- Поток-монитор прогресса ---
     std::thread progress_thread([&]() {
         using namespace std::chrono;
         while (!render_done.load()) {
-            int done = lines_done.load();
-            double frac = double(done) / image_height;
+            int done = tiles_done.load();
+            double frac = double(done) / tile_count;
             auto   now  = steady_clock::now();
             double elapsed   = duration<double>(now - start_time).count();
             double total_est = frac > 0 ? (elapsed / frac) : 0.0;
@@ -240,23 +650,49 @@ int main() {
                   << std::fixed << std::setprecision(1) << total << "s          \n";
     });
 
+    // --- Периодические контрольные точки ---
+    std::thread checkpoint_thread([&]() {
+        using namespace std::chrono;
+        if (!accum) return;
+        auto last_save   = steady_clock::now();
+        int  saved_tiles = 0;
+        while (!render_done.load()) {
+            std::this_thread::sleep_for(seconds(1));
+            int done = tiles_done.load();
+            if (done == saved_tiles || duration<double>(steady_clock::now() - last_save).count() < checkpoint_interval)
+                continue;
+            if (!accum->save(checkpoint_path, checkpoint_info))
+                std::cerr << "\nFailed to write checkpoint " << checkpoint_path << "\n";
+            saved_tiles = done;
+            last_save   = steady_clock::now();
+        }
+    });
+
     // --- Ожидание завершения рендер-потоков --- //
-    for (auto &th : threads) th.join();
+    render_thread.join();
     render_done = true;
     progress_thread.join();
-
-    // --- Вывод готового изображения в PPM ---
-    std::ofstream out("output/image.ppm");
-    out << "P3\n" << image_width << ' ' << image_height << "\n255\n";
-    for (int j = image_height - 1; j >= 0; --j) {
-        for (int i = 0; i < image_width; ++i) {
-            Color c = framebuffer[j * image_width + i];
-            int ir = static_cast<int>(256 * std::clamp(c.x, 0.0, 0.999));
-            int ig = static_cast<int>(256 * std::clamp(c.y, 0.0, 0.999));
-            int ib = static_cast<int>(256 * std::clamp(c.z, 0.0, 0.999));
-            out << ir << ' ' << ig << ' ' << ib << '\n';
-        }
-    }
+    checkpoint_thread.join();
+
+    // Финальная контрольная точка: к готовому кадру можно добавить проб через --resume --spp N
+    if (accum && !accum->save(checkpoint_path, checkpoint_info))
+        std::cerr << "Failed to write checkpoint " << checkpoint_path << "\n";
+    scheduler.print_stats(std::cout);
+    std::cout << "Average spp: " << std::setprecision(1)
+              << double(total_samples) / (double(image_width) * image_height) << "\n";
+
+    // Карта spp кладётся рядом с кадром
+    if (adaptive.write_heatmap)
+        write_spp_heatmap((fs::path(output_path).parent_path() / "spp_heatmap.ppm").string(),
+                          spp_buffer, image_width, image_height, adaptive);
+
+    // --- Вывод готового изображения ---
+    for (const auto& stream : streams)
+        if (!stream->ok())
+            std::cerr << "Failed to write " << stream->path() << "\n";
+    for (const std::string& path : deferred_paths)
+        if (!write_image(path, framebuffer, image_width, image_height))
+            std::cerr << "Failed to write " << path << "\n";
 
     std::cout << "Render complete.\n";
     return 0;
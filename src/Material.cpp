@@ -1,7 +1,7 @@
 #include "Material.h"
 #include "WoodTexture.h"
+#include "Sampler.h"
 #include <cmath>
-#include <random>
 
 // ---- Lambertian ----
 
@@ -19,17 +19,17 @@ bool Lambertian::scatter(
     // bump-mapping для WoodTexture
     if (auto wt = dynamic_cast<const WoodTexture*>(albedo.get())) {
         const Perlin& noise = wt->perlin;
-        const double eps   = 1e-3;
-        double h0 = noise.turb(rec.p);
-        double hx = noise.turb(rec.p + Vec3(eps,0,0));
-        double hy = noise.turb(rec.p + Vec3(0,eps,0));
-        double hz = noise.turb(rec.p + Vec3(0,0,eps));
+        const Real eps   = 1e-3;
+        Real h0 = noise.turb(rec.p);
+        Real hx = noise.turb(rec.p + Vec3(eps,0,0));
+        Real hy = noise.turb(rec.p + Vec3(0,eps,0));
+        Real hz = noise.turb(rec.p + Vec3(0,0,eps));
         Vec3 grad((hx-h0)/eps, (hy-h0)/eps, (hz-h0)/eps);
         N = unit_vector(N + wt->bump_strength * grad);
     }
 
     // Рассеиваем в случайном направлении вокруг N
-    Vec3 scatter_direction = N + Vec3::random(-1,1);
+    Vec3 scatter_direction = N + sample_unit_sphere(sample_2d());
     if (scatter_direction.length_squared() < 1e-8)
         scatter_direction = N;
 
@@ -41,7 +41,7 @@ bool Lambertian::scatter(
 
 // ---- Metal ----
 
-Metal::Metal(const Color& a, double f)
+Metal::Metal(const Color& a, Real f)
   : albedo(a), fuzz(f < 1? f : 1)
 {}
 
@@ -51,7 +51,11 @@ bool Metal::scatter(
     ScatterRecord& srec
 ) const {
     Vec3 reflected = reflect(unit_vector(r_in.direction), rec.normal);
-    srec.specular_ray = Ray(rec.p, reflected + fuzz*Vec3::random());
+    Vec3 jitter;
+    jitter.x = sample_1d();
+    jitter.y = sample_1d();
+    jitter.z = sample_1d();
+    srec.specular_ray = Ray(rec.p, reflected + fuzz*jitter);
     srec.attenuation  = albedo;
     srec.is_specular  = true;
     return (dot(srec.specular_ray.direction, rec.normal) > 0);
@@ -59,7 +63,7 @@ bool Metal::scatter(
 
 // ---- Dielectric ----
 
-Dielectric::Dielectric(double index_of_refraction)
+Dielectric::Dielectric(Real index_of_refraction)
   : ir(index_of_refraction)
 {}
 
@@ -70,13 +74,13 @@ bool Dielectric::scatter(
 ) const {
     srec.attenuation = Color(1,1,1);
     srec.is_specular = true;
-    double refraction_ratio = rec.front_face ? (1.0/ir) : ir;
+    Real refraction_ratio = rec.front_face ? (1.0/ir) : ir;
     Vec3 unit_dir = unit_vector(r_in.direction);
-    double cos_theta = std::fmin(dot(-unit_dir, rec.normal), 1.0);
-    double sin_theta = std::sqrt(1.0 - cos_theta*cos_theta);
+    Real cos_theta = std::fmin(dot(-unit_dir, rec.normal), 1.0);
+    Real sin_theta = std::sqrt(1.0 - cos_theta*cos_theta);
     bool cannot_refract = refraction_ratio * sin_theta > 1.0;
     Vec3 direction;
-    if (cannot_refract || Dielectric::reflectance(cos_theta, refraction_ratio) > Vec3::random().x)
+    if (cannot_refract || Dielectric::reflectance(cos_theta, refraction_ratio) > sample_1d())
         direction = reflect(unit_dir, rec.normal);
     else
         direction = refract(unit_dir, rec.normal, refraction_ratio);
@@ -84,7 +88,7 @@ bool Dielectric::scatter(
     return true;
 }
 
-double Dielectric::reflectance(double cosine, double ref_idx) {
+Real Dielectric::reflectance(Real cosine, Real ref_idx) {
     auto r0 = (1 - ref_idx) / (1 + ref_idx);
     r0 = r0 * r0;
     return r0 + (1 - r0)*std::pow((1 - cosine),5);
@@ -98,3 +102,4 @@ DiffuseLight::DiffuseLight(std::shared_ptr<Texture> a)
 
 Color DiffuseLight::emitted() const {
     return emit->value(0,0,Vec3());
+}
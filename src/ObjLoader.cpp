@@ -0,0 +1,175 @@
+#include "ObjLoader.h"
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+namespace {
+    // Вершина грани: индексы позиции, UV и нормали (-1 — нет)
+    struct ObjVertexKey {
+        int v, vt, vn;
+        bool operator==(const ObjVertexKey& o) const {
+            return v == o.v && vt == o.vt && vn == o.vn;
+        }
+    };
+
+    struct ObjVertexKeyHash {
+        size_t operator()(const ObjVertexKey& k) const {
+            uint64_t h = uint64_t(uint32_t(k.v)) * 0x9E3779B97F4A7C15ull;
+            h ^= uint64_t(uint32_t(k.vt)) * 0xC2B2AE3D27D4EB4Full + (h >> 29);
+            h ^= uint64_t(uint32_t(k.vn)) * 0x165667B19E3779F9ull + (h >> 32);
+            return size_t(h);
+        }
+    };
+
+    // OBJ-индекс (с 1, отрицательный — от конца) -> индекс с 0; -1 при ошибке
+    int resolve_index(long idx, size_t count) {
+        if (idx > 0 && size_t(idx) <= count) return int(idx - 1);
+        if (idx < 0 && size_t(-idx) <= count) return int(long(count) + idx);
+        return -1;
+    }
+
+    const char* skip_spaces(const char* p) {
+        while (*p == ' ' || *p == '\t') ++p;
+        return p;
+    }
+
+    bool parse_doubles(const char* p, double* out, int n) {
+        for (int k = 0; k < n; ++k) {
+            char* end;
+            out[k] = std::strtod(p, &end);
+            if (end == p) return false;
+            p = end;
+        }
+        return true;
+    }
+}
+
+bool load_obj(const std::string& path, ObjMeshData& mesh, std::string& error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+
+    std::vector<Point3> file_positions;
+    std::vector<Vec3>   file_normals;
+    std::vector<UV>     file_uvs;
+    std::unordered_map<ObjVertexKey, uint32_t, ObjVertexKeyHash> vertex_map;
+    std::vector<ObjVertexKey> unified;   // ключи итоговых вершин по порядку
+    std::vector<uint32_t>     face;
+    bool any_uv = false, all_normals = true;
+
+    std::string line;
+    size_t line_no = 0;
+    while (std::getline(in, line)) {
+        ++line_no;
+        const char* p = skip_spaces(line.c_str());
+        auto fail = [&](const char* what) {
+            error = path + ":" + std::to_string(line_no) + ": " + what;
+            return false;
+        };
+
+        if (p[0] == 'v' && (p[1] == ' ' || p[1] == '\t')) {
+            double xyz[3];
+            if (!parse_doubles(p + 2, xyz, 3)) return fail("bad vertex");
+            file_positions.emplace_back(xyz[0], xyz[1], xyz[2]);
+        } else if (p[0] == 'v' && p[1] == 'n' && (p[2] == ' ' || p[2] == '\t')) {
+            double xyz[3];
+            if (!parse_doubles(p + 3, xyz, 3)) return fail("bad normal");
+            file_normals.emplace_back(xyz[0], xyz[1], xyz[2]);
+        } else if (p[0] == 'v' && p[1] == 't' && (p[2] == ' ' || p[2] == '\t')) {
+            double uv[2];
+            if (!parse_doubles(p + 3, uv, 2)) return fail("bad texture coordinate");
+            file_uvs.push_back({ Real(uv[0]), Real(uv[1]) });
+        } else if (p[0] == 'f' && (p[1] == ' ' || p[1] == '\t')) {
+            face.clear();
+            p = skip_spaces(p + 2);
+            while (*p && *p != '\r' && *p != '#') {
+                char* end;
+                ObjVertexKey key{ -1, -1, -1 };
+                long v = std::strtol(p, &end, 10);
+                if (end == p) return fail("bad face");
+                key.v = resolve_index(v, file_positions.size());
+                p = end;
+                if (*p == '/') {
+                    ++p;
+                    if (*p != '/') {
+                        long vt = std::strtol(p, &end, 10);
+                        if (end == p) return fail("bad face");
+                        key.vt = resolve_index(vt, file_uvs.size());
+                        if (key.vt < 0) return fail("texture coordinate index out of range");
+                        p = end;
+                    }
+                    if (*p == '/') {
+                        ++p;
+                        long vn = std::strtol(p, &end, 10);
+                        if (end == p) return fail("bad face");
+                        key.vn = resolve_index(vn, file_normals.size());
+                        if (key.vn < 0) return fail("normal index out of range");
+                        p = end;
+                    }
+                }
+                if (key.v < 0) return fail("vertex index out of range");
+
+                auto it = vertex_map.find(key);
+                uint32_t index;
+                if (it != vertex_map.end()) {
+                    index = it->second;
+                } else {
+                    index = static_cast<uint32_t>(unified.size());
+                    vertex_map.emplace(key, index);
+                    unified.push_back(key);
+                    any_uv      |= key.vt >= 0;
+                    all_normals &= key.vn >= 0;
+                }
+                face.push_back(index);
+                p = skip_spaces(p);
+            }
+            if (face.size() < 3) return fail("face with fewer than 3 vertices");
+            // веер из первой вершины
+            for (size_t k = 1; k + 1 < face.size(); ++k) {
+                mesh.indices.push_back(face[0]);
+                mesh.indices.push_back(face[k]);
+                mesh.indices.push_back(face[k + 1]);
+            }
+        }
+        // остальные директивы (o, g, usemtl, s, ...) не нужны
+    }
+    if (in.bad()) {
+        error = "failed to read " + path;
+        return false;
+    }
+
+    // Итоговые буферы. У вершин без vt — нулевые UV; нормали берутся,
+    // только если они есть у всех вершин, иначе интерполировать нечего
+    const bool use_normals = all_normals && !unified.empty();
+    mesh.positions.resize(unified.size());
+    if (any_uv)      mesh.uvs.assign(unified.size(), UV{ 0.0, 0.0 });
+    if (use_normals) mesh.normals.resize(unified.size());
+    for (size_t i = 0; i < unified.size(); ++i) {
+        const ObjVertexKey& k = unified[i];
+        mesh.positions[i] = file_positions[k.v];
+        if (any_uv && k.vt >= 0) mesh.uvs[i]     = file_uvs[k.vt];
+        if (use_normals)         mesh.normals[i] = file_normals[k.vn];
+    }
+    return true;
+}
+
+std::shared_ptr<TriangleMesh> load_obj_mesh(
+    const std::string& path,
+    std::shared_ptr<Material> material,
+    std::string& error,
+    const ParallelBVHOptions& options
+) {
+    ObjMeshData data;
+    if (!load_obj(path, data, error))
+        return nullptr;
+    if (data.indices.empty()) {
+        error = path + " has no faces";
+        return nullptr;
+    }
+    return std::make_shared<TriangleMesh>(
+        std::move(data.positions), std::move(data.indices), std::move(material),
+        std::move(data.normals), std::move(data.uvs), options);
+}
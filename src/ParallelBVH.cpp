@@ -0,0 +1,338 @@
+#include "ParallelBVH.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Промежуточный узел; поддерево покрывает order[first, first + count)
+    struct BuildNode {
+        AABB       box;
+        BuildNode* children[2] = { nullptr, nullptr };
+        uint32_t   first = 0;
+        uint32_t   count = 0;
+
+        bool is_leaf() const { return children[0] == nullptr; }
+    };
+
+    // Раздвинуть 10 бит так, чтобы между ними было по два нулевых
+    inline uint32_t expand_bits(uint32_t v) {
+        v = (v * 0x00010001u) & 0xFF0000FFu;
+        v = (v * 0x00000101u) & 0x0F00F00Fu;
+        v = (v * 0x00000011u) & 0xC30C30C3u;
+        v = (v * 0x00000005u) & 0x49249249u;
+        return v;
+    }
+
+    // Размер куска для параллельных проходов по массиву
+    inline size_t chunk_size(size_t count, int thread_count) {
+        size_t parts = static_cast<size_t>(std::max(thread_count, 1)) * 4;
+        return std::max<size_t>(1024, (count + parts - 1) / parts);
+    }
+
+    AABB range_bounds(
+        const std::vector<BVHPrimitiveInfo>& prims,
+        const std::vector<size_t>& order,
+        size_t start, size_t end
+    ) {
+        AABB b = AABB::empty();
+        for (size_t i = start; i < end; ++i)
+            b.expand(prims[order[i]].box);
+        return b;
+    }
+
+    // Сборка одного treelet-а; узлы берутся из заранее зарезервированного arena
+    struct TreeletBuilder {
+        const std::vector<BVHPrimitiveInfo>& prims;
+        std::vector<size_t>&                 order;
+        const std::vector<uint32_t>&         codes;
+        std::vector<BuildNode>&              arena;
+        size_t                               max_leaf;
+        size_t                               leaf_batch;
+
+        BuildNode* make_leaf(size_t start, size_t end) {
+            arena.emplace_back();
+            BuildNode* node = &arena.back();
+            node->box   = range_bounds(prims, order, start, end);
+            node->first = static_cast<uint32_t>(start);
+            node->count = static_cast<uint32_t>(end - start);
+            return node;
+        }
+
+        BuildNode* make_interior(size_t start, size_t end, BuildNode* l, BuildNode* r) {
+            arena.emplace_back();
+            BuildNode* node = &arena.back();
+            node->children[0] = l;
+            node->children[1] = r;
+            node->box   = AABB::surrounding_box(l->box, r->box);
+            node->first = static_cast<uint32_t>(start);
+            node->count = static_cast<uint32_t>(end - start);
+            return node;
+        }
+
+        // LBVH: делим по старшему биту, в котором коды диапазона различаются
+        BuildNode* build_morton(size_t start, size_t end, int bit) {
+            size_t count = end - start;
+            if (count <= max_leaf)
+                return make_leaf(start, end);
+
+            while (bit >= 0) {
+                uint32_t mask = 1u << bit;
+                if ((codes[start] & mask) != (codes[end - 1] & mask)) break;
+                --bit;
+            }
+
+            size_t mid;
+            if (bit < 0) {
+                // коды совпадают целиком — делим пополам
+                mid = start + count / 2;
+            } else {
+                uint32_t mask = 1u << bit;
+                mid = static_cast<size_t>(std::partition_point(
+                    codes.begin() + start, codes.begin() + end,
+                    [mask](uint32_t c) { return (c & mask) == 0; }) - codes.begin());
+            }
+
+            BuildNode* l = build_morton(start, mid, bit - 1);
+            BuildNode* r = build_morton(mid,   end, bit - 1);
+            return make_interior(start, end, l, r);
+        }
+
+        // Уточнение: тот же диапазон, но разбиение по SAH
+        BuildNode* build_sah(size_t start, size_t end) {
+            size_t count = end - start;
+            if (count == 1)
+                return make_leaf(start, end);
+
+            SAHSplit split = sah_partition(prims, order, start, end);
+            size_t batches = (count + leaf_batch - 1) / leaf_batch;
+            if (count <= max_leaf && split.cost >= SAH_INTERSECT_COST * batches)
+                return make_leaf(start, end);
+
+            BuildNode* l = build_sah(start,     split.mid);
+            BuildNode* r = build_sah(split.mid, end);
+            return make_interior(start, end, l, r);
+        }
+    };
+
+    // Верхние уровни: SAH над корнями treelet-ов
+    BuildNode* build_top(
+        std::vector<BuildNode*>& roots,
+        const std::vector<BVHPrimitiveInfo>& infos,
+        std::vector<size_t>& torder,
+        size_t start, size_t end,
+        std::vector<BuildNode>& arena
+    ) {
+        if (end - start == 1)
+            return roots[torder[start]];
+
+        SAHSplit split = sah_partition(infos, torder, start, end);
+        BuildNode* l = build_top(roots, infos, torder, start,     split.mid, arena);
+        BuildNode* r = build_top(roots, infos, torder, split.mid, end,       arena);
+
+        arena.emplace_back();
+        BuildNode* node = &arena.back();
+        node->children[0] = l;
+        node->children[1] = r;
+        node->box = AABB::surrounding_box(l->box, r->box);
+        return node;
+    }
+
+    // Перенос дерева в плоский массив; примитивы выписываются в порядке обхода
+    struct Flattener {
+        const std::vector<size_t>&  order;
+        std::vector<LinearBVHNode>& nodes;
+        std::vector<uint32_t>&      out_order;
+
+        void collect(const BuildNode* n) {
+            if (n->is_leaf()) {
+                for (uint32_t i = n->first; i < n->first + n->count; ++i)
+                    out_order.push_back(static_cast<uint32_t>(order[i]));
+                return;
+            }
+            collect(n->children[0]);
+            collect(n->children[1]);
+        }
+
+        void flatten(const BuildNode* n, uint32_t index, int depth) {
+            nodes[index].set_bounds(n->box);
+            if (n->is_leaf() || depth >= LINEAR_BVH_MAX_DEPTH - 1) {
+                // слишком глубокое поддерево схлопывается в один лист
+                uint32_t first = static_cast<uint32_t>(out_order.size());
+                collect(n);
+                nodes[index].left_first = first;
+                nodes[index].count      = static_cast<uint32_t>(out_order.size()) - first;
+                return;
+            }
+
+            uint32_t left = static_cast<uint32_t>(nodes.size());
+            nodes.resize(nodes.size() + 2);
+            nodes[index].left_first = left;
+            nodes[index].count      = 0;
+            flatten(n->children[0], left,     depth + 1);
+            flatten(n->children[1], left + 1, depth + 1);
+        }
+    };
+}
+
+uint32_t morton_code_3d(double x, double y, double z) {
+    auto quantize = [](double v) {
+        return static_cast<uint32_t>(std::min(std::max(v * 1024.0, 0.0), 1023.0));
+    };
+    return (expand_bits(quantize(x)) << 2)
+         | (expand_bits(quantize(y)) << 1)
+         |  expand_bits(quantize(z));
+}
+
+void radix_sort_morton(
+    std::vector<std::pair<uint32_t, uint32_t>>& items,
+    int thread_count
+) {
+    constexpr int RADIX_BITS = 8;
+    constexpr int BUCKETS    = 1 << RADIX_BITS;
+    constexpr int PASSES     = 32 / RADIX_BITS;
+
+    size_t n      = items.size();
+    size_t chunk  = chunk_size(n, thread_count);
+    size_t chunks = (n + chunk - 1) / chunk;
+
+    std::vector<std::pair<uint32_t, uint32_t>> temp(n);
+    std::vector<size_t> offsets(chunks * BUCKETS);
+
+    for (int pass = 0; pass < PASSES; ++pass) {
+        int shift = pass * RADIX_BITS;
+
+        // 1) Гистограммы по кускам
+        std::fill(offsets.begin(), offsets.end(), 0);
+        parallel_for(chunks, thread_count, [&](size_t c) {
+            size_t* hist = &offsets[c * BUCKETS];
+            size_t  end  = std::min(n, (c + 1) * chunk);
+            for (size_t i = c * chunk; i < end; ++i)
+                ++hist[(items[i].first >> shift) & (BUCKETS - 1)];
+        });
+
+        // 2) Префиксные суммы: разряд важнее куска, так сортировка устойчива
+        size_t sum = 0;
+        for (int b = 0; b < BUCKETS; ++b) {
+            for (size_t c = 0; c < chunks; ++c) {
+                size_t cnt = offsets[c * BUCKETS + b];
+                offsets[c * BUCKETS + b] = sum;
+                sum += cnt;
+            }
+        }
+
+        // 3) Раскладка
+        parallel_for(chunks, thread_count, [&](size_t c) {
+            size_t* pos = &offsets[c * BUCKETS];
+            size_t  end = std::min(n, (c + 1) * chunk);
+            for (size_t i = c * chunk; i < end; ++i)
+                temp[pos[(items[i].first >> shift) & (BUCKETS - 1)]++] = items[i];
+        });
+
+        items.swap(temp);
+    }
+}
+
+void build_linear_bvh_parallel(
+    const std::vector<BVHPrimitiveInfo>& prims,
+    const ParallelBVHOptions& options,
+    std::vector<LinearBVHNode>& nodes,
+    std::vector<uint32_t>& order
+) {
+    nodes.clear();
+    order.clear();
+    if (prims.empty()) return;
+
+    const int    threads = std::max(options.thread_count, 1);
+    const size_t n       = prims.size();
+    const size_t chunk   = chunk_size(n, threads);
+    const size_t chunks  = (n + chunk - 1) / chunk;
+
+    // 1) Границы центров: частичные коробки по кускам
+    std::vector<AABB> partial(chunks, AABB::empty());
+    parallel_for(chunks, threads, [&](size_t c) {
+        size_t end = std::min(n, (c + 1) * chunk);
+        for (size_t i = c * chunk; i < end; ++i)
+            partial[c].expand(prims[i].centroid);
+    });
+    AABB centroid_bounds = AABB::empty();
+    for (const AABB& b : partial) centroid_bounds.expand(b);
+
+    // 2) Коды Мортона центров, нормированных в единичный куб
+    Vec3 extent = centroid_bounds.maximum - centroid_bounds.minimum;
+    Vec3 inv_extent(
+        extent.x > 0 ? 1.0 / extent.x : 0.0,
+        extent.y > 0 ? 1.0 / extent.y : 0.0,
+        extent.z > 0 ? 1.0 / extent.z : 0.0
+    );
+    std::vector<std::pair<uint32_t, uint32_t>> items(n);
+    parallel_for(n, threads, [&](size_t i) {
+        Vec3 c = (prims[i].centroid - centroid_bounds.minimum) * inv_extent;
+        items[i] = { morton_code_3d(c.x, c.y, c.z), static_cast<uint32_t>(i) };
+    }, chunk);
+
+    // 3) Сортировка по коду
+    radix_sort_morton(items, threads);
+
+    std::vector<size_t>   sorted(n);
+    std::vector<uint32_t> codes(n);
+    for (size_t i = 0; i < n; ++i) {
+        codes[i]  = items[i].first;
+        sorted[i] = items[i].second;
+    }
+    items.clear();
+    items.shrink_to_fit();
+
+    // 4) Treelet-ы: отрезки с одинаковыми верхними битами кода
+    const int      low_bits = 30 - LBVH_TREELET_BITS;
+    const uint32_t mask     = ~((1u << low_bits) - 1u);
+    std::vector<std::pair<size_t, size_t>> treelets;
+    for (size_t start = 0, end = 1; end <= n; ++end) {
+        if (end == n || (codes[start] & mask) != (codes[end] & mask)) {
+            treelets.emplace_back(start, end);
+            start = end;
+        }
+    }
+
+    // Крупные treelet-ы — первыми, чтобы потоки не простаивали в конце
+    std::vector<size_t> schedule(treelets.size());
+    for (size_t i = 0; i < schedule.size(); ++i) schedule[i] = i;
+    std::sort(schedule.begin(), schedule.end(), [&](size_t a, size_t b) {
+        return treelets[a].second - treelets[a].first
+             > treelets[b].second - treelets[b].first;
+    });
+
+    std::vector<std::vector<BuildNode>> arenas(treelets.size());
+    std::vector<BuildNode*>             roots(treelets.size());
+    const size_t max_leaf   = static_cast<size_t>(std::max(options.max_leaf_size, 1));
+    const size_t leaf_batch = static_cast<size_t>(std::max(options.leaf_batch_size, 1));
+    parallel_for(schedule.size(), threads, [&](size_t k) {
+        size_t t = schedule[k];
+        size_t start = treelets[t].first;
+        size_t end   = treelets[t].second;
+        arenas[t].reserve(2 * (end - start));
+        TreeletBuilder builder{ prims, sorted, codes, arenas[t], max_leaf, leaf_batch };
+        roots[t] = options.sah_refine
+            ? builder.build_sah(start, end)
+            : builder.build_morton(start, end, low_bits - 1);
+    });
+
+    // 5) Верх дерева по SAH над treelet-ами
+    std::vector<BVHPrimitiveInfo> infos(roots.size());
+    std::vector<size_t>           torder(roots.size());
+    for (size_t t = 0; t < roots.size(); ++t) {
+        infos[t].box      = roots[t]->box;
+        infos[t].centroid = roots[t]->box.centroid();
+        torder[t]         = t;
+    }
+    std::vector<BuildNode> top_arena;
+    top_arena.reserve(2 * roots.size());
+    BuildNode* root = build_top(roots, infos, torder, 0, roots.size(), top_arena);
+
+    // 6) Плоский массив
+    nodes.reserve(2 * n);
+    nodes.resize(1);
+    order.reserve(n);
+    Flattener flattener{ sorted, nodes, order };
+    flattener.flatten(root, 0, 0);
+    nodes.shrink_to_fit();
+}
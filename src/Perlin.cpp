@@ -1,21 +1,30 @@
 #include "Perlin.h"
+#include "Random.h"
 #include <algorithm>
+#include <atomic>
 
-Perlin::Perlin() {
-    auto p = generate_perm();
+// каждый экземпляр получает своё зерно по порядку создания
+static std::atomic<uint64_t> instance_counter{0};
+
+Perlin::Perlin() : Perlin(instance_counter++) {}
+
+Perlin::Perlin(uint64_t seed) : perm_seed(seed) {
+    auto p = generate_perm(seed);
     for (int i = 0; i < pointCount; ++i)
         perm[i] = perm[i+pointCount] = p[i];
 }
 
-std::array<int, Perlin::pointCount> Perlin::generate_perm() {
+std::array<int, Perlin::pointCount> Perlin::generate_perm(uint64_t seed) {
     std::array<int, pointCount> p;
     std::iota(p.begin(), p.end(), 0);
-    std::mt19937 gen(std::random_device{}());
-    std::shuffle(p.begin(), p.end(), gen);
+    // Фишер–Йетс на PCG32: std::shuffle зависит от реализации библиотеки
+    Rng rng(mix64(seed), 0x5045524C494Eull);
+    for (int i = pointCount - 1; i > 0; --i)
+        std::swap(p[i], p[rng.next_bounded(uint32_t(i) + 1)]);
     return p;
 }
 
-double Perlin::noise(const Point3& p) const {
+Real Perlin::noise(const Point3& p) const {
     auto x = p.x - std::floor(p.x);
     auto y = p.y - std::floor(p.y);
     auto z = p.z - std::floor(p.z);
@@ -23,11 +32,11 @@ double Perlin::noise(const Point3& p) const {
     int yi = (int)std::floor(p.y) & 255;
     int zi = (int)std::floor(p.z) & 255;
 
-    double u = fade(x), v = fade(y), w = fade(z);
+    Real u = fade(x), v = fade(y), w = fade(z);
     int A  = perm[xi]   + yi, AA = perm[A]   + zi, AB = perm[A+1] + zi;
     int B  = perm[xi+1] + yi, BA = perm[B]   + zi, BB = perm[B+1] + zi;
 
-    double res = lerp(w,
+    Real res = lerp(w,
         lerp(v,
              lerp(u, grad(perm[AA],   x,   y,   z),
                       grad(perm[BA],   x-1, y,   z)),
@@ -42,10 +51,10 @@ double Perlin::noise(const Point3& p) const {
     return (res + 1.0) / 2.0;
 }
 
-double Perlin::turb(const Point3& p, int depth) const {
-    double accum = 0;
+Real Perlin::turb(const Point3& p, int depth) const {
+    Real accum = 0;
     Point3  temp = p;
-    double weight = 1.0;
+    Real weight = 1.0;
     for (int i = 0; i < depth; ++i) {
         accum    += weight * noise(temp);
         weight  *= 0.5;
@@ -54,11 +63,11 @@ double Perlin::turb(const Point3& p, int depth) const {
     return accum;
 }
 
-double Perlin::fade(double t)    { return t*t*t*(t*(t*6-15)+10); }
-double Perlin::lerp(double t, double a, double b) { return a + t*(b-a); }
-double Perlin::grad(int hash, double x, double y, double z) {
+Real Perlin::fade(Real t)    { return t*t*t*(t*(t*6-15)+10); }
+Real Perlin::lerp(Real t, Real a, Real b) { return a + t*(b-a); }
+Real Perlin::grad(int hash, Real x, Real y, Real z) {
     int h = hash & 15;
-    double u = h<8 ? x : y;
-    double v = h<4 ? y : (h==12||h==14 ? x : z);
+    Real u = h<8 ? x : y;
+    Real v = h<4 ? y : (h==12||h==14 ? x : z);
     return ((h&1)? -u : u) + ((h&2)? -v : v);
 }
@@ -0,0 +1,219 @@
+#include "PrimitiveStore.h"
+#include "PrimitiveKernels.h"
+#include "Sphere.h"
+#include "XYRect.h"
+#include "XZRect.h"
+#include "YZRect.h"
+#include "Box.h"
+
+PrimitiveKind primitive_kind(const Hittable* obj) {
+    if (dynamic_cast<const Sphere*>(obj)) return PrimitiveKind::Sphere;
+    if (dynamic_cast<const XYRect*>(obj)) return PrimitiveKind::XYRect;
+    if (dynamic_cast<const XZRect*>(obj)) return PrimitiveKind::XZRect;
+    if (dynamic_cast<const YZRect*>(obj)) return PrimitiveKind::YZRect;
+    if (auto b = dynamic_cast<const Box*>(obj))
+        return b->is_oriented() ? PrimitiveKind::Other : PrimitiveKind::Box;
+    return PrimitiveKind::Other;
+}
+
+void PrimitiveStore::build(
+    const std::vector<HittablePtr>& objects,
+    const std::vector<uint32_t>& order
+) {
+    refs.clear();
+    owners.clear();
+    spheres = SphereArrays();
+    for (auto& r : rects) r.clear();
+    boxes.clear();
+
+    sphere_batch = sphere_batch_kernel(detect_simd_level());
+    refs.reserve(order.size());
+    owners.reserve(order.size());
+    for (uint32_t idx : order) {
+        const Hittable* obj = objects[idx].get();
+        PrimitiveKind kind  = primitive_kind(obj);
+        uint32_t      slot  = 0;
+        switch (kind) {
+        case PrimitiveKind::Sphere: {
+            auto s = static_cast<const Sphere*>(obj);
+            slot = uint32_t(spheres.radius.size());
+            spheres.cx.push_back(s->center.x);
+            spheres.cy.push_back(s->center.y);
+            spheres.cz.push_back(s->center.z);
+            spheres.radius.push_back(s->radius);
+            break;
+        }
+        case PrimitiveKind::XYRect: {
+            auto q = static_cast<const XYRect*>(obj);
+            slot = uint32_t(rects[0].size());
+            rects[0].push_back({ q->x0, q->x1, q->y0, q->y1, q->k });
+            break;
+        }
+        case PrimitiveKind::XZRect: {
+            auto q = static_cast<const XZRect*>(obj);
+            slot = uint32_t(rects[1].size());
+            rects[1].push_back({ q->x0, q->x1, q->z0, q->z1, q->k });
+            break;
+        }
+        case PrimitiveKind::YZRect: {
+            auto q = static_cast<const YZRect*>(obj);
+            slot = uint32_t(rects[2].size());
+            rects[2].push_back({ q->y0, q->y1, q->z0, q->z1, q->k });
+            break;
+        }
+        case PrimitiveKind::Box: {
+            auto b = static_cast<const Box*>(obj);
+            slot = uint32_t(boxes.size());
+            boxes.push_back({ { b->box_min.x, b->box_min.y, b->box_min.z },
+                              { b->box_max.x, b->box_max.y, b->box_max.z } });
+            break;
+        }
+        case PrimitiveKind::Other:
+            break;
+        }
+        refs.push_back((uint32_t(kind) << KIND_SHIFT) | slot);
+        owners.push_back(obj);
+    }
+}
+
+uint32_t PrimitiveStore::sphere_run(uint32_t i, uint32_t end) const {
+    // сферы листа сгруппированы: подряд и в слотах, и в SoA-массивах
+    const uint32_t sphere = uint32_t(PrimitiveKind::Sphere);
+    uint32_t n = 1;
+    while (i + n < end && (refs[i + n] >> KIND_SHIFT) == sphere)
+        ++n;
+    return n;
+}
+
+bool PrimitiveStore::intersect(
+    uint32_t first, uint32_t count,
+    const Ray& r, Real t_min, Real& closest,
+    Intersection& isect
+) const {
+    bool hit_anything = false;
+    const uint32_t end = first + count;
+    for (uint32_t i = first; i < end; ++i) {
+        const uint32_t idx = refs[i] & INDEX_MASK;
+        Real t, a, b;
+        switch (PrimitiveKind(refs[i] >> KIND_SHIFT)) {
+        case PrimitiveKind::Sphere: {
+            const uint32_t run = sphere_run(i, end);
+            uint32_t lane = 0;
+            bool     found;
+            if (run == 1) {
+                found = intersect_sphere(spheres.cx[idx], spheres.cy[idx], spheres.cz[idx],
+                                         spheres.radius[idx], r, t_min, closest, t);
+            } else {
+                t     = closest;
+                found = sphere_batch(&spheres.cx[idx], &spheres.cy[idx], &spheres.cz[idx],
+                                     &spheres.radius[idx], run, r, t_min, t, lane);
+            }
+            const uint32_t slot = i + lane;
+            i += run - 1;
+            if (!found)
+                continue;
+            isect.set(t, owners[slot]);
+            break;
+        }
+        case PrimitiveKind::XYRect: {
+            const RectData& q = rects[0][idx];
+            if (!intersect_axis_rect<&Vec3::x, &Vec3::y, &Vec3::z>(
+                    q.a0, q.a1, q.b0, q.b1, q.k, r, t_min, closest, t, a, b))
+                continue;
+            isect.set(t, owners[i], 0, a, b);
+            break;
+        }
+        case PrimitiveKind::XZRect: {
+            const RectData& q = rects[1][idx];
+            if (!intersect_axis_rect<&Vec3::x, &Vec3::z, &Vec3::y>(
+                    q.a0, q.a1, q.b0, q.b1, q.k, r, t_min, closest, t, a, b))
+                continue;
+            isect.set(t, owners[i], 0, a, b);
+            break;
+        }
+        case PrimitiveKind::YZRect: {
+            const RectData& q = rects[2][idx];
+            if (!intersect_axis_rect<&Vec3::y, &Vec3::z, &Vec3::x>(
+                    q.a0, q.a1, q.b0, q.b1, q.k, r, t_min, closest, t, a, b))
+                continue;
+            isect.set(t, owners[i], 0, a, b);
+            break;
+        }
+        case PrimitiveKind::Box: {
+            const BoxData& q = boxes[idx];
+            int  axis;
+            bool exit;
+            if (!intersect_box_slab(q.box_min, q.box_max, r, t_min, closest, t, axis, exit))
+                continue;
+            isect.set(t, owners[i], box_face_id(axis, exit));
+            break;
+        }
+        case PrimitiveKind::Other:
+            if (!owners[i]->intersect(r, t_min, closest, isect))
+                continue;
+            break;
+        }
+        closest      = isect.t;
+        hit_anything = true;
+    }
+    return hit_anything;
+}
+
+bool PrimitiveStore::occluded(
+    uint32_t first, uint32_t count,
+    const Ray& r, Real t_min, Real t_max
+) const {
+    const uint32_t end = first + count;
+    for (uint32_t i = first; i < end; ++i) {
+        const uint32_t idx = refs[i] & INDEX_MASK;
+        Real   t, a, b;
+        bool   hit = false;
+        switch (PrimitiveKind(refs[i] >> KIND_SHIFT)) {
+        case PrimitiveKind::Sphere: {
+            const uint32_t run = sphere_run(i, end);
+            if (run == 1) {
+                hit = intersect_sphere(spheres.cx[idx], spheres.cy[idx], spheres.cz[idx],
+                                       spheres.radius[idx], r, t_min, t_max, t);
+            } else {
+                uint32_t lane;
+                t   = t_max;
+                hit = sphere_batch(&spheres.cx[idx], &spheres.cy[idx], &spheres.cz[idx],
+                                   &spheres.radius[idx], run, r, t_min, t, lane);
+            }
+            i += run - 1;
+            break;
+        }
+        case PrimitiveKind::XYRect: {
+            const RectData& q = rects[0][idx];
+            hit = intersect_axis_rect<&Vec3::x, &Vec3::y, &Vec3::z>(
+                q.a0, q.a1, q.b0, q.b1, q.k, r, t_min, t_max, t, a, b);
+            break;
+        }
+        case PrimitiveKind::XZRect: {
+            const RectData& q = rects[1][idx];
+            hit = intersect_axis_rect<&Vec3::x, &Vec3::z, &Vec3::y>(
+                q.a0, q.a1, q.b0, q.b1, q.k, r, t_min, t_max, t, a, b);
+            break;
+        }
+        case PrimitiveKind::YZRect: {
+            const RectData& q = rects[2][idx];
+            hit = intersect_axis_rect<&Vec3::y, &Vec3::z, &Vec3::x>(
+                q.a0, q.a1, q.b0, q.b1, q.k, r, t_min, t_max, t, a, b);
+            break;
+        }
+        case PrimitiveKind::Box: {
+            const BoxData& q = boxes[idx];
+            int  axis;
+            bool exit;
+            hit = intersect_box_slab(q.box_min, q.box_max, r, t_min, t_max, t, axis, exit);
+            break;
+        }
+        case PrimitiveKind::Other:
+            hit = owners[i]->occluded(r, t_min, t_max);
+            break;
+        }
+        if (hit)
+            return true;
+    }
+    return false;
+}
@@ -1,11 +1,12 @@
 #include "Ray.h"
 
-Ray::Ray() = default;
-
 Ray::Ray(const Point3& origin, const Vec3& direction)
-    : origin(origin), direction(direction)
+    : origin(origin)
+    , direction(direction)
+    , inv_direction(Real(1) / direction.x, Real(1) / direction.y, Real(1) / direction.z)
+    , sign{ inv_direction.x < 0, inv_direction.y < 0, inv_direction.z < 0 }
 {}
 
-Point3 Ray::at(double t) const {
+Point3 Ray::at(Real t) const {
     return origin + t * direction;
 }
@@ -0,0 +1,235 @@
+#include "Sampler.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr double ONE_OVER_2_32 = 1.0 / 4294967296.0;
+
+// равномерное число в [0,1) из 64-битного хеша
+double hash_to_double(uint64_t h) {
+    return static_cast<double>(h >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// i-й элемент псевдослучайной перестановки {0..n-1} (Kensler, 2013)
+uint32_t permutation_element(uint32_t i, uint32_t n, uint32_t p) {
+    uint32_t w = n - 1;
+    w |= w >> 1;
+    w |= w >> 2;
+    w |= w >> 4;
+    w |= w >> 8;
+    w |= w >> 16;
+    do {
+        i ^= p;             i *= 0xe170893du;
+        i ^= p >> 16;       i ^= (i & w) >> 4;
+        i ^= p >> 8;        i *= 0x0929eb3fu;
+        i ^= p >> 23;       i ^= (i & w) >> 1;
+        i *= 1u | p >> 27;  i *= 0x6935fa69u;
+        i ^= (i & w) >> 11; i *= 0x74dcb303u;
+        i ^= (i & w) >> 2;  i *= 0x9e501cc3u;
+        i ^= (i & w) >> 2;  i *= 0xc860a3dfu;
+        i &= w;
+        i ^= i >> 5;
+    } while (i >= n);
+    return (i + p) % n;
+}
+
+uint32_t reverse_bits(uint32_t x) {
+    x = (x << 16) | (x >> 16);
+    x = ((x & 0x00ff00ffu) << 8) | ((x & 0xff00ff00u) >> 8);
+    x = ((x & 0x0f0f0f0fu) << 4) | ((x & 0xf0f0f0f0u) >> 4);
+    x = ((x & 0x33333333u) << 2) | ((x & 0xccccccccu) >> 2);
+    x = ((x & 0x55555555u) << 1) | ((x & 0xaaaaaaaau) >> 1);
+    return x;
+}
+
+// хеш-перестановка Лэйна–Карраса в варианте Burley (2020): младшие биты
+// влияют только на старшие, т.е. на битах в обратном порядке это
+// вложенное перемешивание Оуэна
+uint32_t laine_karras_permutation(uint32_t x, uint32_t seed) {
+    x += seed;
+    x ^= x * 0x6c50b47cu;
+    x ^= x * 0xb82f1e52u;
+    x ^= x * 0xc7afe638u;
+    x ^= x * 0x8d22f6e6u;
+    return x;
+}
+
+uint32_t owen_scramble(uint32_t x, uint32_t seed) {
+    return reverse_bits(laine_karras_permutation(reverse_bits(x), seed));
+}
+
+// первые два измерения Соболя: ван дер Корпут и матрица полинома x+1
+uint32_t sobol_dim0(uint32_t index) {
+    return reverse_bits(index);
+}
+
+uint32_t sobol_dim1(uint32_t index) {
+    uint32_t result = 0;
+    for (uint32_t v = 1u << 31; index; index >>= 1, v ^= v >> 1)
+        if (index & 1) result ^= v;
+    return result;
+}
+
+constexpr int HALTON_PRIME_COUNT = 64;
+constexpr int HALTON_PRIMES[HALTON_PRIME_COUNT] = {
+      2,   3,   5,   7,  11,  13,  17,  19,  23,  29,  31,  37,  41,  43,  47,  53,
+     59,  61,  67,  71,  73,  79,  83,  89,  97, 101, 103, 107, 109, 113, 127, 131,
+    137, 139, 149, 151, 157, 163, 167, 173, 179, 181, 191, 193, 197, 199, 211, 223,
+    227, 229, 233, 239, 241, 251, 257, 263, 269, 271, 277, 281, 283, 293, 307, 311
+};
+
+// обратный радикал по основанию base с перемешиванием Оуэна: каждая цифра
+// переставляется в зависимости от уже выписанных старших цифр. Ведущие
+// нули тоже переставляются, иначе при больших основаниях первые пробы
+// прижимаются к нулю.
+double owen_scrambled_radical_inverse(int base, uint64_t index, uint64_t hash) {
+    const double inv_base = 1.0 / base;
+    double inv_base_n = 1.0;
+    uint64_t reversed = 0;
+    while (inv_base_n > 1.0 / 4294967296.0) {
+        uint64_t next  = index / base;
+        uint32_t digit = static_cast<uint32_t>(index - next * base);
+        uint32_t digit_hash = static_cast<uint32_t>(mix64(hash ^ reversed));
+        digit      = permutation_element(digit, static_cast<uint32_t>(base), digit_hash);
+        reversed   = reversed * base + digit;
+        inv_base_n *= inv_base;
+        index       = next;
+    }
+    return std::fmin(reversed * inv_base_n, 0x1.fffffffffffffp-1);
+}
+
+} // namespace
+
+// --- Sampler ----------------------------------------------------------------
+
+Sampler::Sampler(int samples_per_pixel, uint32_t seed)
+    : spp(samples_per_pixel > 0 ? samples_per_pixel : 1), seed(seed)
+{}
+
+void Sampler::start_pixel_sample(uint64_t pixel_index, int sample_index) {
+    pixel     = pixel_index;
+    sample    = sample_index;
+    dimension = 0;
+    // измерения, которые ещё берут числа напрямую из PCG32, тоже детерминированы
+    seed_thread_rng(pixel_index, static_cast<uint32_t>(sample_index), seed);
+}
+
+uint64_t Sampler::dimension_hash(int dim) const {
+    return mix64(mix64(pixel ^ (uint64_t(seed) << 40)) + uint64_t(dim));
+}
+
+std::unique_ptr<Sampler> make_sampler(SamplerType type, int samples_per_pixel, uint32_t seed) {
+    switch (type) {
+        case SamplerType::Stratified: return std::make_unique<StratifiedSampler>(samples_per_pixel, seed);
+        case SamplerType::Halton:     return std::make_unique<HaltonSampler>(samples_per_pixel, seed);
+        case SamplerType::Sobol:      return std::make_unique<SobolSampler>(samples_per_pixel, seed);
+        case SamplerType::Independent:
+        default:                      return std::make_unique<IndependentSampler>(samples_per_pixel, seed);
+    }
+}
+
+// --- IndependentSampler -----------------------------------------------------
+
+double IndependentSampler::get_1d() {
+    ++dimension;
+    return thread_rng().next_double();
+}
+
+Sample2D IndependentSampler::get_2d() {
+    dimension += 2;
+    double x = thread_rng().next_double();
+    double y = thread_rng().next_double();
+    return { x, y };
+}
+
+std::unique_ptr<Sampler> IndependentSampler::clone() const {
+    return std::make_unique<IndependentSampler>(*this);
+}
+
+// --- StratifiedSampler ------------------------------------------------------
+
+StratifiedSampler::StratifiedSampler(int samples_per_pixel, uint32_t seed)
+    : Sampler(samples_per_pixel, seed)
+{
+    // почти квадратная сетка, покрывающая все пробы
+    x_strata = std::max(1, static_cast<int>(std::sqrt(static_cast<double>(spp))));
+    y_strata = (spp + x_strata - 1) / x_strata;
+}
+
+double StratifiedSampler::get_1d() {
+    uint64_t h = dimension_hash(dimension++);
+    uint32_t n = static_cast<uint32_t>(spp);
+    uint32_t stratum = permutation_element(static_cast<uint32_t>(sample) % n, n, static_cast<uint32_t>(h));
+    double jitter = hash_to_double(mix64(h + uint64_t(sample)));
+    return (stratum + jitter) / n;
+}
+
+Sample2D StratifiedSampler::get_2d() {
+    uint64_t h = dimension_hash(dimension);
+    dimension += 2;
+    uint32_t n = static_cast<uint32_t>(x_strata * y_strata);
+    uint32_t stratum = permutation_element(static_cast<uint32_t>(sample) % n, n, static_cast<uint32_t>(h));
+    int sx = static_cast<int>(stratum % x_strata);
+    int sy = static_cast<int>(stratum / x_strata);
+    uint64_t j = mix64(h + uint64_t(sample));
+    double dx = hash_to_double(j);
+    double dy = hash_to_double(mix64(j));
+    return { (sx + dx) / x_strata, (sy + dy) / y_strata };
+}
+
+std::unique_ptr<Sampler> StratifiedSampler::clone() const {
+    return std::make_unique<StratifiedSampler>(*this);
+}
+
+// --- HaltonSampler ----------------------------------------------------------
+
+double HaltonSampler::halton(int dim) {
+    uint64_t h = dimension_hash(dim);
+    if (dim >= HALTON_PRIME_COUNT)
+        return hash_to_double(mix64(h + uint64_t(sample)));
+    // своё перемешивание цифр в каждом пикселе и измерении
+    return owen_scrambled_radical_inverse(HALTON_PRIMES[dim], static_cast<uint64_t>(sample), h);
+}
+
+double HaltonSampler::get_1d() {
+    return halton(dimension++);
+}
+
+Sample2D HaltonSampler::get_2d() {
+    double x = halton(dimension++);
+    double y = halton(dimension++);
+    return { x, y };
+}
+
+std::unique_ptr<Sampler> HaltonSampler::clone() const {
+    return std::make_unique<HaltonSampler>(*this);
+}
+
+// --- SobolSampler -----------------------------------------------------------
+//
+// «Дополненный» Соболь: каждое 1D/2D-измерение берётся из первых
+// измерений Соболя со своим перемешиванием Оуэна, а порядок проб
+// перемешивается отдельно. Любые первые 2^k проб остаются
+// стратифицированными (0,2)-последовательностью.
+
+double SobolSampler::get_1d() {
+    uint64_t h = dimension_hash(dimension++);
+    uint32_t index = owen_scramble(static_cast<uint32_t>(sample), static_cast<uint32_t>(h));
+    return owen_scramble(sobol_dim0(index), static_cast<uint32_t>(h >> 32)) * ONE_OVER_2_32;
+}
+
+Sample2D SobolSampler::get_2d() {
+    uint64_t h = dimension_hash(dimension);
+    dimension += 2;
+    uint32_t index = owen_scramble(static_cast<uint32_t>(sample), static_cast<uint32_t>(h));
+    uint64_t hs = mix64(h);
+    double x = owen_scramble(sobol_dim0(index), static_cast<uint32_t>(hs))       * ONE_OVER_2_32;
+    double y = owen_scramble(sobol_dim1(index), static_cast<uint32_t>(hs >> 32)) * ONE_OVER_2_32;
+    return { x, y };
+}
+
+std::unique_ptr<Sampler> SobolSampler::clone() const {
+    return std::make_unique<SobolSampler>(*this);
+}
@@ -0,0 +1,492 @@
+#include "SceneFile.h"
+#include "ParallelBVH.h"
+#include "Sphere.h"
+#include "Box.h"
+#include "XYRect.h"
+#include "XZRect.h"
+#include "YZRect.h"
+#include "Material.h"
+#include "ConstantTexture.h"
+#include "NoiseTexture.h"
+#include "WoodTexture.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+#ifdef _WIN32
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    // Раскладка файла (машинный порядок байт, все секции выровнены на 8):
+    //   SceneFileHeader
+    //   SceneTextureRecord[texture_count]     — дети текстуры всегда раньше родителя
+    //   SceneMaterialRecord[material_count]
+    //   ScenePrimitiveRecord[primitive_count]
+    //   LinearBVHNode[node_count]
+    //   uint32_t order[primitive_count]
+    struct SceneFileHeader {
+        char     magic[4];   // "RTSC"
+        uint32_t version;
+        uint32_t texture_count;
+        uint32_t material_count;
+        uint32_t primitive_count;
+        uint32_t node_count;
+        uint64_t texture_offset;
+        uint64_t material_offset;
+        uint64_t primitive_offset;
+        uint64_t node_offset;
+        uint64_t order_offset;
+        uint64_t file_size;
+    };
+
+    enum class TextureType : uint32_t { Constant, Noise, Wood };
+    enum class MaterialType : uint32_t { Lambertian, Metal, Dielectric, DiffuseLight };
+    enum class PrimitiveType : uint32_t { Sphere, XYRect, XZRect, YZRect, Box };
+
+    struct SceneTextureRecord {
+        TextureType type;
+        uint32_t    child[2];      // Wood: светлая и тёмная текстуры
+        uint32_t    reserved;
+        double      color[3];      // Constant
+        double      scale;         // Noise, Wood
+        double      bump;          // Wood
+        uint64_t    perlin_seed;   // Noise, Wood
+    };
+
+    struct SceneMaterialRecord {
+        MaterialType type;
+        uint32_t     texture;      // Lambertian, DiffuseLight
+        double       color[3];     // Metal: albedo
+        double       param;        // Metal: fuzz, Dielectric: показатель преломления
+    };
+
+    struct ScenePrimitiveRecord {
+        PrimitiveType type;
+        uint32_t      material;
+        double        data[6];     // Sphere: центр, радиус; Rect: a0, a1, b0, b1, k; Box: min, max
+    };
+
+    static_assert(sizeof(SceneFileHeader) % 8 == 0, "header must keep 8-byte alignment");
+    static_assert(sizeof(SceneTextureRecord) % 8 == 0, "record must keep 8-byte alignment");
+    static_assert(sizeof(SceneMaterialRecord) % 8 == 0, "record must keep 8-byte alignment");
+    static_assert(sizeof(ScenePrimitiveRecord) % 8 == 0, "record must keep 8-byte alignment");
+
+    const char SCENE_MAGIC[4] = { 'R', 'T', 'S', 'C' };
+
+    uint64_t align8(uint64_t x) { return (x + 7) & ~uint64_t(7); }
+
+    void copy3(double* dst, const Vec3& v) {
+        dst[0] = v.x;
+        dst[1] = v.y;
+        dst[2] = v.z;
+    }
+
+    // --- Запись: обход объектов с дедупликацией материалов и текстур ---
+
+    class SceneWriter {
+    public:
+        std::vector<SceneTextureRecord>   textures;
+        std::vector<SceneMaterialRecord>  materials;
+        std::vector<ScenePrimitiveRecord> primitives;
+        std::string                       error;
+
+        bool add_object(const Hittable* obj) {
+            ScenePrimitiveRecord rec{};
+            const Material* mat = nullptr;
+            if (auto s = dynamic_cast<const Sphere*>(obj)) {
+                rec.type = PrimitiveType::Sphere;
+                copy3(rec.data, s->center);
+                rec.data[3] = s->radius;
+                mat = s->mat_ptr.get();
+            } else if (auto q = dynamic_cast<const XYRect*>(obj)) {
+                rec.type = PrimitiveType::XYRect;
+                set_rect(rec, q->x0, q->x1, q->y0, q->y1, q->k);
+                mat = q->mp.get();
+            } else if (auto q = dynamic_cast<const XZRect*>(obj)) {
+                rec.type = PrimitiveType::XZRect;
+                set_rect(rec, q->x0, q->x1, q->z0, q->z1, q->k);
+                mat = q->mp.get();
+            } else if (auto q = dynamic_cast<const YZRect*>(obj)) {
+                rec.type = PrimitiveType::YZRect;
+                set_rect(rec, q->y0, q->y1, q->z0, q->z1, q->k);
+                mat = q->mp.get();
+            } else if (auto b = dynamic_cast<const Box*>(obj)) {
+                if (b->is_oriented()) {
+                    error = "rotated boxes are not supported in scene files";
+                    return false;
+                }
+                rec.type = PrimitiveType::Box;
+                copy3(rec.data, b->box_min);
+                copy3(rec.data + 3, b->box_max);
+                mat = b->mat_ptr.get();
+            } else {
+                error = "unsupported primitive type in scene";
+                return false;
+            }
+            if (!add_material(mat, rec.material))
+                return false;
+            primitives.push_back(rec);
+            return true;
+        }
+
+    private:
+        std::unordered_map<const Material*, uint32_t> material_index;
+        std::unordered_map<const Texture*, uint32_t>  texture_index;
+
+        static void set_rect(ScenePrimitiveRecord& rec, double a0, double a1,
+                             double b0, double b1, double k) {
+            rec.data[0] = a0;
+            rec.data[1] = a1;
+            rec.data[2] = b0;
+            rec.data[3] = b1;
+            rec.data[4] = k;
+        }
+
+        bool add_material(const Material* mat, uint32_t& index) {
+            auto it = material_index.find(mat);
+            if (it != material_index.end()) {
+                index = it->second;
+                return true;
+            }
+            SceneMaterialRecord rec{};
+            if (auto m = dynamic_cast<const Lambertian*>(mat)) {
+                rec.type = MaterialType::Lambertian;
+                if (!add_texture(m->albedo.get(), rec.texture)) return false;
+            } else if (auto m = dynamic_cast<const Metal*>(mat)) {
+                rec.type  = MaterialType::Metal;
+                copy3(rec.color, m->albedo);
+                rec.param = m->fuzz;
+            } else if (auto m = dynamic_cast<const Dielectric*>(mat)) {
+                rec.type  = MaterialType::Dielectric;
+                rec.param = m->index_of_refraction();
+            } else if (auto m = dynamic_cast<const DiffuseLight*>(mat)) {
+                rec.type = MaterialType::DiffuseLight;
+                if (!add_texture(m->emit.get(), rec.texture)) return false;
+            } else {
+                error = "unsupported material type in scene";
+                return false;
+            }
+            index = static_cast<uint32_t>(materials.size());
+            materials.push_back(rec);
+            material_index[mat] = index;
+            return true;
+        }
+
+        bool add_texture(const Texture* tex, uint32_t& index) {
+            auto it = texture_index.find(tex);
+            if (it != texture_index.end()) {
+                index = it->second;
+                return true;
+            }
+            SceneTextureRecord rec{};
+            if (auto t = dynamic_cast<const ConstantTexture*>(tex)) {
+                rec.type = TextureType::Constant;
+                copy3(rec.color, t->color);
+            } else if (auto t = dynamic_cast<const NoiseTexture*>(tex)) {
+                rec.type        = TextureType::Noise;
+                rec.scale       = t->scale;
+                rec.perlin_seed = t->noise.seed();
+            } else if (auto t = dynamic_cast<const WoodTexture*>(tex)) {
+                rec.type        = TextureType::Wood;
+                rec.scale       = t->scale;
+                rec.bump        = t->bump_strength;
+                rec.perlin_seed = t->perlin.seed();
+                if (!add_texture(t->light.get(), rec.child[0])) return false;
+                if (!add_texture(t->dark.get(),  rec.child[1])) return false;
+            } else {
+                error = "unsupported texture type in scene";
+                return false;
+            }
+            index = static_cast<uint32_t>(textures.size());
+            textures.push_back(rec);
+            texture_index[tex] = index;
+            return true;
+        }
+    };
+
+    // --- Отображение файла в память ---
+
+    class MappedFile {
+    public:
+        explicit MappedFile(const std::string& path) {
+#ifdef _WIN32
+            // без mmap: читаем файл целиком
+            std::ifstream in(path, std::ios::binary);
+            if (!in) return;
+            buffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+            data = buffer.data();
+            size = buffer.size();
+#else
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) return;
+            struct stat st;
+            if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+                void* p = ::mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+                if (p != MAP_FAILED) {
+                    data = static_cast<const char*>(p);
+                    size = size_t(st.st_size);
+                }
+            }
+            ::close(fd);
+#endif
+        }
+
+        ~MappedFile() {
+#ifndef _WIN32
+            if (data) ::munmap(const_cast<char*>(data), size);
+#endif
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        const char* data = nullptr;
+        size_t      size = 0;
+
+    private:
+#ifdef _WIN32
+        std::vector<char> buffer;
+#endif
+    };
+
+    // секция [offset, offset + count * sizeof(T)) целиком внутри файла
+    template <typename T>
+    const T* section(const MappedFile& file, uint64_t offset, uint64_t count) {
+        if (offset % alignof(T) != 0 || offset > file.size
+            || count > (file.size - offset) / sizeof(T))
+            return nullptr;
+        return reinterpret_cast<const T*>(file.data + offset);
+    }
+}
+
+bool write_scene_file(
+    const std::string& path,
+    const HittableList& world,
+    const ParallelBVHOptions& options,
+    std::string& error
+) {
+    SceneWriter writer;
+    for (const HittablePtr& obj : world.objects) {
+        if (!writer.add_object(obj.get())) {
+            error = writer.error;
+            return false;
+        }
+    }
+
+    // BVH строится так же, как при рендере, и пишется уже плоским
+    std::vector<BVHPrimitiveInfo> prims(world.objects.size());
+    for (size_t i = 0; i < prims.size(); ++i) {
+        AABB b;
+        world.objects[i]->bounding_box(0.0, 1.0, b);
+        prims[i].box      = b;
+        prims[i].centroid = b.centroid();
+    }
+    std::vector<LinearBVHNode> nodes;
+    std::vector<uint32_t>      order;
+    build_linear_bvh_parallel(prims, options, nodes, order);
+
+    SceneFileHeader header{};
+    std::memcpy(header.magic, SCENE_MAGIC, sizeof(SCENE_MAGIC));
+    header.version          = SCENE_FILE_VERSION;
+    header.texture_count    = static_cast<uint32_t>(writer.textures.size());
+    header.material_count   = static_cast<uint32_t>(writer.materials.size());
+    header.primitive_count  = static_cast<uint32_t>(writer.primitives.size());
+    header.node_count       = static_cast<uint32_t>(nodes.size());
+    header.texture_offset   = sizeof(SceneFileHeader);
+    header.material_offset  = header.texture_offset   + writer.textures.size()   * sizeof(SceneTextureRecord);
+    header.primitive_offset = header.material_offset  + writer.materials.size()  * sizeof(SceneMaterialRecord);
+    header.node_offset      = header.primitive_offset + writer.primitives.size() * sizeof(ScenePrimitiveRecord);
+    header.order_offset     = header.node_offset      + nodes.size()             * sizeof(LinearBVHNode);
+    header.file_size        = align8(header.order_offset + order.size() * sizeof(uint32_t));
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        error = "cannot create " + path;
+        return false;
+    }
+    auto write = [&](const void* p, size_t n) { out.write(static_cast<const char*>(p), std::streamsize(n)); };
+    write(&header, sizeof(header));
+    write(writer.textures.data(),   writer.textures.size()   * sizeof(SceneTextureRecord));
+    write(writer.materials.data(),  writer.materials.size()  * sizeof(SceneMaterialRecord));
+    write(writer.primitives.data(), writer.primitives.size() * sizeof(ScenePrimitiveRecord));
+    write(nodes.data(),             nodes.size()             * sizeof(LinearBVHNode));
+    write(order.data(),             order.size()             * sizeof(uint32_t));
+    const char pad[8] = {};
+    write(pad, header.file_size - (header.order_offset + order.size() * sizeof(uint32_t)));
+    if (!out) {
+        error = "failed to write " + path;
+        return false;
+    }
+    return true;
+}
+
+bool load_scene_file(const std::string& path, LoadedScene& scene, std::string& error) {
+    MappedFile file(path);
+    if (!file.data) {
+        error = "cannot open " + path;
+        return false;
+    }
+
+    const SceneFileHeader* header = section<SceneFileHeader>(file, 0, 1);
+    if (!header || std::memcmp(header->magic, SCENE_MAGIC, sizeof(SCENE_MAGIC)) != 0) {
+        error = path + " is not a scene file";
+        return false;
+    }
+    if (header->version != SCENE_FILE_VERSION) {
+        error = "unsupported scene file version " + std::to_string(header->version);
+        return false;
+    }
+    const auto* textures   = section<SceneTextureRecord>(file, header->texture_offset, header->texture_count);
+    const auto* materials  = section<SceneMaterialRecord>(file, header->material_offset, header->material_count);
+    const auto* primitives = section<ScenePrimitiveRecord>(file, header->primitive_offset, header->primitive_count);
+    const auto* nodes      = section<LinearBVHNode>(file, header->node_offset, header->node_count);
+    const auto* order      = section<uint32_t>(file, header->order_offset, header->primitive_count);
+    if (header->file_size != file.size || !textures || !materials || !primitives || !nodes || !order) {
+        error = path + " is truncated or corrupt";
+        return false;
+    }
+
+    // Текстуры: дети записаны раньше родителя, поэтому уже созданы
+    std::vector<std::shared_ptr<Texture>> tex(header->texture_count);
+    for (uint32_t i = 0; i < header->texture_count; ++i) {
+        const SceneTextureRecord& r = textures[i];
+        switch (r.type) {
+        case TextureType::Constant:
+            tex[i] = std::make_shared<ConstantTexture>(Color(r.color[0], r.color[1], r.color[2]));
+            break;
+        case TextureType::Noise:
+            tex[i] = std::make_shared<NoiseTexture>(r.scale, r.perlin_seed);
+            break;
+        case TextureType::Wood:
+            if (r.child[0] >= i || r.child[1] >= i) {
+                error = path + ": bad texture reference";
+                return false;
+            }
+            tex[i] = std::make_shared<WoodTexture>(r.scale, tex[r.child[0]], tex[r.child[1]],
+                                                   r.bump, r.perlin_seed);
+            break;
+        default:
+            error = path + ": unknown texture type";
+            return false;
+        }
+    }
+
+    std::vector<std::shared_ptr<Material>> mat(header->material_count);
+    for (uint32_t i = 0; i < header->material_count; ++i) {
+        const SceneMaterialRecord& r = materials[i];
+        bool uses_texture = r.type == MaterialType::Lambertian || r.type == MaterialType::DiffuseLight;
+        if (uses_texture && r.texture >= header->texture_count) {
+            error = path + ": bad texture reference";
+            return false;
+        }
+        switch (r.type) {
+        case MaterialType::Lambertian:
+            mat[i] = std::make_shared<Lambertian>(tex[r.texture]);
+            break;
+        case MaterialType::Metal:
+            mat[i] = std::make_shared<Metal>(Color(r.color[0], r.color[1], r.color[2]), r.param);
+            break;
+        case MaterialType::Dielectric:
+            mat[i] = std::make_shared<Dielectric>(r.param);
+            break;
+        case MaterialType::DiffuseLight:
+            mat[i] = std::make_shared<DiffuseLight>(tex[r.texture]);
+            break;
+        default:
+            error = path + ": unknown material type";
+            return false;
+        }
+    }
+
+    scene.objects.clear();
+    scene.objects.reserve(header->primitive_count);
+    for (uint32_t i = 0; i < header->primitive_count; ++i) {
+        const ScenePrimitiveRecord& r = primitives[i];
+        if (r.material >= header->material_count) {
+            error = path + ": bad material reference";
+            return false;
+        }
+        const double* d = r.data;
+        const auto&   m = mat[r.material];
+        switch (r.type) {
+        case PrimitiveType::Sphere:
+            scene.objects.push_back(std::make_shared<Sphere>(Point3(d[0], d[1], d[2]), d[3], m));
+            break;
+        case PrimitiveType::XYRect:
+            scene.objects.push_back(std::make_shared<XYRect>(d[0], d[1], d[2], d[3], d[4], m));
+            break;
+        case PrimitiveType::XZRect:
+            scene.objects.push_back(std::make_shared<XZRect>(d[0], d[1], d[2], d[3], d[4], m));
+            break;
+        case PrimitiveType::YZRect:
+            scene.objects.push_back(std::make_shared<YZRect>(d[0], d[1], d[2], d[3], d[4], m));
+            break;
+        case PrimitiveType::Box:
+            scene.objects.push_back(std::make_shared<Box>(Point3(d[0], d[1], d[2]), Point3(d[3], d[4], d[5]), m));
+            break;
+        default:
+            error = path + ": unknown primitive type";
+            return false;
+        }
+    }
+
+    // BVH используется как есть, поэтому проверяется всё, на что полагается
+    // обход: order — перестановка, дерево есть тогда и только тогда, когда
+    // есть примитивы, дети внутреннего узла лежат после него (циклов нет),
+    // глубина укладывается в стек обхода, а достижимые из корня листья
+    // покрывают каждый слот order ровно один раз
+    std::vector<uint8_t> seen(header->primitive_count, 0);
+    for (uint32_t i = 0; i < header->primitive_count; ++i) {
+        if (order[i] >= header->primitive_count || seen[order[i]]) {
+            error = path + ": bad BVH primitive order";
+            return false;
+        }
+        seen[order[i]] = 1;
+    }
+    if ((header->node_count == 0) != (header->primitive_count == 0)) {
+        error = path + ": BVH does not match primitive count";
+        return false;
+    }
+    std::vector<int>     depth(header->node_count, -1);   // -1 — узел недостижим из корня
+    std::vector<uint8_t> covered(header->primitive_count, 0);
+    uint32_t             covered_count = 0;
+    if (header->node_count > 0)
+        depth[0] = 0;
+    for (uint32_t i = 0; i < header->node_count; ++i) {
+        if (depth[i] < 0)
+            continue;
+        const LinearBVHNode& n = nodes[i];
+        bool valid = n.is_leaf() ? uint64_t(n.left_first) + n.count <= header->primitive_count
+                                 : n.left_first > i && uint64_t(n.left_first) + 1 < header->node_count
+                                   && depth[i] + 1 < LINEAR_BVH_MAX_DEPTH;
+        if (valid && n.is_leaf()) {
+            for (uint32_t k = n.left_first; k < n.left_first + n.count && valid; ++k) {
+                valid = !covered[k];
+                covered[k] = 1;
+            }
+            covered_count += n.count;
+        }
+        if (!valid) {
+            error = path + ": bad BVH node";
+            return false;
+        }
+        if (!n.is_leaf()) {
+            depth[n.left_first]     = std::max(depth[n.left_first], depth[i] + 1);
+            depth[n.left_first + 1] = std::max(depth[n.left_first + 1], depth[i] + 1);
+        }
+    }
+    if (covered_count != header->primitive_count) {
+        error = path + ": BVH leaves do not cover all primitives";
+        return false;
+    }
+    scene.bvh_nodes.assign(nodes, nodes + header->node_count);
+    scene.bvh_order.assign(order, order + header->primitive_count);
+    return true;
+}
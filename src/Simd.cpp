@@ -0,0 +1,10 @@
+#include "Simd.h"
+
+SimdLevel detect_simd_level() {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return SimdLevel::AVX2;
+    if (__builtin_cpu_supports("sse2")) return SimdLevel::SSE;
+#endif
+    return SimdLevel::Scalar;
+}
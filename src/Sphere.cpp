@@ -1,40 +1,36 @@
 #include "Sphere.h"
-#include <cmath>
+#include "PrimitiveKernels.h"
 
 Sphere::Sphere()
     : center(Point3(0,0,0)), radius(0), mat_ptr(nullptr)
 {}
 
-Sphere::Sphere(Point3 cen, double r, std::shared_ptr<Material> m)
+Sphere::Sphere(Point3 cen, Real r, std::shared_ptr<Material> m)
     : center(cen), radius(r), mat_ptr(m)
 {}
 
-bool Sphere::hit(const Ray& r, double t_min, double t_max, HitRecord& rec) const {
-    Vec3 oc = r.origin - center;
-    double a = r.direction.length_squared();
-    double half_b = dot(oc, r.direction);
-    double c = oc.length_squared() - radius*radius;
-    double discriminant = half_b*half_b - a*c;
-    if (discriminant < 0) return false;
-    double sqrtd = std::sqrt(discriminant);
-
-    double root = (-half_b - sqrtd) / a;
-    if (root < t_min || root > t_max) {
-        root = (-half_b + sqrtd) / a;
-        if (root < t_min || root > t_max)
-            return false;
-    }
+bool Sphere::intersect(const Ray& r, Real t_min, Real t_max, Intersection& isect) const {
+    Real t;
+    if (!intersect_sphere(center.x, center.y, center.z, radius, r, t_min, t_max, t))
+        return false;
+    isect.set(t, this);
+    return true;
+}
 
-    rec.t = root;
+void Sphere::surface(const Ray& r, const Intersection& isect, HitRecord& rec) const {
+    rec.t = isect.t;
     rec.p = r.at(rec.t);
     Vec3 outward_normal = (rec.p - center) / radius;
     rec.set_face_normal(r, outward_normal);
-    rec.mat_ptr = mat_ptr;
+    rec.mat_ptr = mat_ptr.get();
+}
 
-    return true;
+bool Sphere::occluded(const Ray& r, Real t_min, Real t_max) const {
+    Real t;
+    return intersect_sphere(center.x, center.y, center.z, radius, r, t_min, t_max, t);
 }
 
-bool Sphere::bounding_box(double time0, double time1, AABB& output_box) const {
+bool Sphere::bounding_box(Real time0, Real time1, AABB& output_box) const {
     output_box = AABB(
         center - Vec3(radius, radius, radius),
         center + Vec3(radius, radius, radius)
@@ -0,0 +1,299 @@
+#include "SphereBatch.h"
+#include "PrimitiveKernels.h"
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define RT_SPHERE_BATCH_X86 1
+#include <immintrin.h>
+#endif
+
+bool intersect_spheres_scalar(
+    const Real* cx, const Real* cy, const Real* cz, const Real* radius,
+    uint32_t count, const Ray& r, Real t_min, Real& t_max, uint32_t& index
+) {
+    bool found = false;
+    for (uint32_t i = 0; i < count; ++i) {
+        Real t;
+        if (intersect_sphere(cx[i], cy[i], cz[i], radius[i], r, t_min, t_max, t)) {
+            t_max = t;
+            index = i;
+            found = true;
+        }
+    }
+    return found;
+}
+
+namespace {
+    // Выбор ближайшего из lanes корней пакета; mask — дорожки с корнем в
+    // [t_min, t_max] исходной границы. Порядок «<=» по возрастанию номера
+    // повторяет последовательный обход: из равных побеждает последняя сфера
+    inline bool pick_nearest(
+        const Real* t, int mask, int lanes, uint32_t base,
+        Real& t_max, uint32_t& index
+    ) {
+        bool found = false;
+        for (int k = 0; k < lanes; ++k) {
+            if ((mask >> k & 1) && t[k] <= t_max) {
+                t_max = t[k];
+                index = base + uint32_t(k);
+                found = true;
+            }
+        }
+        return found;
+    }
+
+#if defined(RT_SPHERE_BATCH_X86) && !defined(RT_REAL_FLOAT)
+    // double: 2 дорожки SSE2, 4 дорожки AVX2
+    __attribute__((target("sse2")))
+    bool intersect_spheres_sse(
+        const Real* cx, const Real* cy, const Real* cz, const Real* radius,
+        uint32_t count, const Ray& r, Real t_min, Real& t_max, uint32_t& index
+    ) {
+        const Vec3& o = r.origin;
+        const Vec3& d = r.direction;
+        const double  a_scalar = d.x*d.x + d.y*d.y + d.z*d.z;
+        const __m128d ox = _mm_set1_pd(o.x), oy = _mm_set1_pd(o.y), oz = _mm_set1_pd(o.z);
+        const __m128d dx = _mm_set1_pd(d.x), dy = _mm_set1_pd(d.y), dz = _mm_set1_pd(d.z);
+        const __m128d a    = _mm_set1_pd(a_scalar);
+        const __m128d tmin = _mm_set1_pd(t_min);
+        const __m128d sign = _mm_set1_pd(-0.0);
+
+        bool found = false;
+        for (uint32_t i = 0; i < count; i += 2) {
+            const int lanes = count - i >= 2 ? 2 : 1;
+            __m128d px, py, pz, rad;
+            if (lanes == 2) {
+                px  = _mm_loadu_pd(cx + i);
+                py  = _mm_loadu_pd(cy + i);
+                pz  = _mm_loadu_pd(cz + i);
+                rad = _mm_loadu_pd(radius + i);
+            } else {
+                px  = _mm_load_sd(cx + i);
+                py  = _mm_load_sd(cy + i);
+                pz  = _mm_load_sd(cz + i);
+                rad = _mm_load_sd(radius + i);
+            }
+            const __m128d tmax = _mm_set1_pd(t_max);
+
+            __m128d ocx = _mm_sub_pd(ox, px);
+            __m128d ocy = _mm_sub_pd(oy, py);
+            __m128d ocz = _mm_sub_pd(oz, pz);
+            __m128d half_b = _mm_add_pd(_mm_add_pd(_mm_mul_pd(ocx, dx), _mm_mul_pd(ocy, dy)),
+                                        _mm_mul_pd(ocz, dz));
+            __m128d oc2 = _mm_add_pd(_mm_add_pd(_mm_mul_pd(ocx, ocx), _mm_mul_pd(ocy, ocy)),
+                                     _mm_mul_pd(ocz, ocz));
+            __m128d c    = _mm_sub_pd(oc2, _mm_mul_pd(rad, rad));
+            __m128d disc = _mm_sub_pd(_mm_mul_pd(half_b, half_b), _mm_mul_pd(a, c));
+            // отрицательный дискриминант даёт NaN: упорядоченные сравнения его отвергают
+            __m128d sq    = _mm_sqrt_pd(disc);
+            __m128d neg_b = _mm_xor_pd(half_b, sign);
+            __m128d r1 = _mm_div_pd(_mm_sub_pd(neg_b, sq), a);
+            __m128d r2 = _mm_div_pd(_mm_add_pd(neg_b, sq), a);
+            __m128d in1 = _mm_and_pd(_mm_cmpge_pd(r1, tmin), _mm_cmple_pd(r1, tmax));
+            __m128d in2 = _mm_and_pd(_mm_cmpge_pd(r2, tmin), _mm_cmple_pd(r2, tmax));
+            __m128d t   = _mm_or_pd(_mm_and_pd(in1, r1), _mm_andnot_pd(in1, r2));
+            int mask = _mm_movemask_pd(_mm_or_pd(in1, in2)) & ((1 << lanes) - 1);
+            if (!mask) continue;
+
+            alignas(16) double tv[2];
+            _mm_store_pd(tv, t);
+            found |= pick_nearest(tv, mask, lanes, i, t_max, index);
+        }
+        return found;
+    }
+
+    __attribute__((target("avx2")))
+    bool intersect_spheres_avx2(
+        const Real* cx, const Real* cy, const Real* cz, const Real* radius,
+        uint32_t count, const Ray& r, Real t_min, Real& t_max, uint32_t& index
+    ) {
+        const Vec3& o = r.origin;
+        const Vec3& d = r.direction;
+        const double  a_scalar = d.x*d.x + d.y*d.y + d.z*d.z;
+        const __m256d ox = _mm256_set1_pd(o.x), oy = _mm256_set1_pd(o.y), oz = _mm256_set1_pd(o.z);
+        const __m256d dx = _mm256_set1_pd(d.x), dy = _mm256_set1_pd(d.y), dz = _mm256_set1_pd(d.z);
+        const __m256d a    = _mm256_set1_pd(a_scalar);
+        const __m256d tmin = _mm256_set1_pd(t_min);
+        const __m256d sign = _mm256_set1_pd(-0.0);
+
+        bool found = false;
+        for (uint32_t i = 0; i < count; i += 4) {
+            const int lanes = count - i >= 4 ? 4 : int(count - i);
+            __m256d px, py, pz, rad;
+            if (lanes == 4) {
+                px  = _mm256_loadu_pd(cx + i);
+                py  = _mm256_loadu_pd(cy + i);
+                pz  = _mm256_loadu_pd(cz + i);
+                rad = _mm256_loadu_pd(radius + i);
+            } else {
+                // хвост пакета: за концом массивов не читаем
+                const __m256i load = _mm256_cmpgt_epi64(_mm256_set1_epi64x(lanes),
+                                                        _mm256_setr_epi64x(0, 1, 2, 3));
+                px  = _mm256_maskload_pd(cx + i, load);
+                py  = _mm256_maskload_pd(cy + i, load);
+                pz  = _mm256_maskload_pd(cz + i, load);
+                rad = _mm256_maskload_pd(radius + i, load);
+            }
+            const __m256d tmax = _mm256_set1_pd(t_max);
+
+            __m256d ocx = _mm256_sub_pd(ox, px);
+            __m256d ocy = _mm256_sub_pd(oy, py);
+            __m256d ocz = _mm256_sub_pd(oz, pz);
+            __m256d half_b = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(ocx, dx), _mm256_mul_pd(ocy, dy)),
+                                           _mm256_mul_pd(ocz, dz));
+            __m256d oc2 = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(ocx, ocx), _mm256_mul_pd(ocy, ocy)),
+                                        _mm256_mul_pd(ocz, ocz));
+            __m256d c    = _mm256_sub_pd(oc2, _mm256_mul_pd(rad, rad));
+            __m256d disc = _mm256_sub_pd(_mm256_mul_pd(half_b, half_b), _mm256_mul_pd(a, c));
+            __m256d sq    = _mm256_sqrt_pd(disc);
+            __m256d neg_b = _mm256_xor_pd(half_b, sign);
+            __m256d r1 = _mm256_div_pd(_mm256_sub_pd(neg_b, sq), a);
+            __m256d r2 = _mm256_div_pd(_mm256_add_pd(neg_b, sq), a);
+            __m256d in1 = _mm256_and_pd(_mm256_cmp_pd(r1, tmin, _CMP_GE_OQ), _mm256_cmp_pd(r1, tmax, _CMP_LE_OQ));
+            __m256d in2 = _mm256_and_pd(_mm256_cmp_pd(r2, tmin, _CMP_GE_OQ), _mm256_cmp_pd(r2, tmax, _CMP_LE_OQ));
+            __m256d t   = _mm256_blendv_pd(r2, r1, in1);
+            int mask = _mm256_movemask_pd(_mm256_or_pd(in1, in2)) & ((1 << lanes) - 1);
+            if (!mask) continue;
+
+            alignas(32) double tv[4];
+            _mm256_store_pd(tv, t);
+            found |= pick_nearest(tv, mask, lanes, i, t_max, index);
+        }
+        return found;
+    }
+#elif defined(RT_SPHERE_BATCH_X86)
+    // float (RT_REAL_FLOAT): 4 дорожки SSE2, 8 дорожек AVX2
+    __attribute__((target("sse2")))
+    bool intersect_spheres_sse(
+        const Real* cx, const Real* cy, const Real* cz, const Real* radius,
+        uint32_t count, const Ray& r, Real t_min, Real& t_max, uint32_t& index
+    ) {
+        const Vec3& o = r.origin;
+        const Vec3& d = r.direction;
+        const float  a_scalar = d.x*d.x + d.y*d.y + d.z*d.z;
+        const __m128 ox = _mm_set1_ps(o.x), oy = _mm_set1_ps(o.y), oz = _mm_set1_ps(o.z);
+        const __m128 dx = _mm_set1_ps(d.x), dy = _mm_set1_ps(d.y), dz = _mm_set1_ps(d.z);
+        const __m128 a    = _mm_set1_ps(a_scalar);
+        const __m128 tmin = _mm_set1_ps(t_min);
+        const __m128 sign = _mm_set1_ps(-0.0f);
+
+        bool found = false;
+        for (uint32_t i = 0; i < count; i += 4) {
+            const int lanes = count - i >= 4 ? 4 : int(count - i);
+            __m128 px, py, pz, rad;
+            if (lanes == 4) {
+                px  = _mm_loadu_ps(cx + i);
+                py  = _mm_loadu_ps(cy + i);
+                pz  = _mm_loadu_ps(cz + i);
+                rad = _mm_loadu_ps(radius + i);
+            } else {
+                // хвост пакета: за концом массивов не читаем
+                alignas(16) float tail[4][4] = {};
+                for (int k = 0; k < lanes; ++k) {
+                    tail[0][k] = cx[i + k];
+                    tail[1][k] = cy[i + k];
+                    tail[2][k] = cz[i + k];
+                    tail[3][k] = radius[i + k];
+                }
+                px  = _mm_load_ps(tail[0]);
+                py  = _mm_load_ps(tail[1]);
+                pz  = _mm_load_ps(tail[2]);
+                rad = _mm_load_ps(tail[3]);
+            }
+            const __m128 tmax = _mm_set1_ps(t_max);
+
+            __m128 ocx = _mm_sub_ps(ox, px);
+            __m128 ocy = _mm_sub_ps(oy, py);
+            __m128 ocz = _mm_sub_ps(oz, pz);
+            __m128 half_b = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ocx, dx), _mm_mul_ps(ocy, dy)),
+                                       _mm_mul_ps(ocz, dz));
+            __m128 oc2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ocx, ocx), _mm_mul_ps(ocy, ocy)),
+                                    _mm_mul_ps(ocz, ocz));
+            __m128 c    = _mm_sub_ps(oc2, _mm_mul_ps(rad, rad));
+            __m128 disc = _mm_sub_ps(_mm_mul_ps(half_b, half_b), _mm_mul_ps(a, c));
+            __m128 sq    = _mm_sqrt_ps(disc);
+            __m128 neg_b = _mm_xor_ps(half_b, sign);
+            __m128 r1 = _mm_div_ps(_mm_sub_ps(neg_b, sq), a);
+            __m128 r2 = _mm_div_ps(_mm_add_ps(neg_b, sq), a);
+            __m128 in1 = _mm_and_ps(_mm_cmpge_ps(r1, tmin), _mm_cmple_ps(r1, tmax));
+            __m128 in2 = _mm_and_ps(_mm_cmpge_ps(r2, tmin), _mm_cmple_ps(r2, tmax));
+            __m128 t   = _mm_or_ps(_mm_and_ps(in1, r1), _mm_andnot_ps(in1, r2));
+            int mask = _mm_movemask_ps(_mm_or_ps(in1, in2)) & ((1 << lanes) - 1);
+            if (!mask) continue;
+
+            alignas(16) float tv[4];
+            _mm_store_ps(tv, t);
+            found |= pick_nearest(tv, mask, lanes, i, t_max, index);
+        }
+        return found;
+    }
+
+    __attribute__((target("avx2")))
+    bool intersect_spheres_avx2(
+        const Real* cx, const Real* cy, const Real* cz, const Real* radius,
+        uint32_t count, const Ray& r, Real t_min, Real& t_max, uint32_t& index
+    ) {
+        const Vec3& o = r.origin;
+        const Vec3& d = r.direction;
+        const float  a_scalar = d.x*d.x + d.y*d.y + d.z*d.z;
+        const __m256 ox = _mm256_set1_ps(o.x), oy = _mm256_set1_ps(o.y), oz = _mm256_set1_ps(o.z);
+        const __m256 dx = _mm256_set1_ps(d.x), dy = _mm256_set1_ps(d.y), dz = _mm256_set1_ps(d.z);
+        const __m256 a    = _mm256_set1_ps(a_scalar);
+        const __m256 tmin = _mm256_set1_ps(t_min);
+        const __m256 sign = _mm256_set1_ps(-0.0f);
+
+        bool found = false;
+        for (uint32_t i = 0; i < count; i += 8) {
+            const int lanes = count - i >= 8 ? 8 : int(count - i);
+            __m256 px, py, pz, rad;
+            if (lanes == 8) {
+                px  = _mm256_loadu_ps(cx + i);
+                py  = _mm256_loadu_ps(cy + i);
+                pz  = _mm256_loadu_ps(cz + i);
+                rad = _mm256_loadu_ps(radius + i);
+            } else {
+                // хвост пакета: за концом массивов не читаем
+                const __m256i load = _mm256_cmpgt_epi32(_mm256_set1_epi32(lanes),
+                                                        _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+                px  = _mm256_maskload_ps(cx + i, load);
+                py  = _mm256_maskload_ps(cy + i, load);
+                pz  = _mm256_maskload_ps(cz + i, load);
+                rad = _mm256_maskload_ps(radius + i, load);
+            }
+            const __m256 tmax = _mm256_set1_ps(t_max);
+
+            __m256 ocx = _mm256_sub_ps(ox, px);
+            __m256 ocy = _mm256_sub_ps(oy, py);
+            __m256 ocz = _mm256_sub_ps(oz, pz);
+            __m256 half_b = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ocx, dx), _mm256_mul_ps(ocy, dy)),
+                                          _mm256_mul_ps(ocz, dz));
+            __m256 oc2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ocx, ocx), _mm256_mul_ps(ocy, ocy)),
+                                       _mm256_mul_ps(ocz, ocz));
+            __m256 c    = _mm256_sub_ps(oc2, _mm256_mul_ps(rad, rad));
+            __m256 disc = _mm256_sub_ps(_mm256_mul_ps(half_b, half_b), _mm256_mul_ps(a, c));
+            __m256 sq    = _mm256_sqrt_ps(disc);
+            __m256 neg_b = _mm256_xor_ps(half_b, sign);
+            __m256 r1 = _mm256_div_ps(_mm256_sub_ps(neg_b, sq), a);
+            __m256 r2 = _mm256_div_ps(_mm256_add_ps(neg_b, sq), a);
+            __m256 in1 = _mm256_and_ps(_mm256_cmp_ps(r1, tmin, _CMP_GE_OQ), _mm256_cmp_ps(r1, tmax, _CMP_LE_OQ));
+            __m256 in2 = _mm256_and_ps(_mm256_cmp_ps(r2, tmin, _CMP_GE_OQ), _mm256_cmp_ps(r2, tmax, _CMP_LE_OQ));
+            __m256 t   = _mm256_blendv_ps(r2, r1, in1);
+            int mask = _mm256_movemask_ps(_mm256_or_ps(in1, in2)) & ((1 << lanes) - 1);
+            if (!mask) continue;
+
+            alignas(32) float tv[8];
+            _mm256_store_ps(tv, t);
+            found |= pick_nearest(tv, mask, lanes, i, t_max, index);
+        }
+        return found;
+    }
+#endif
+}
+
+SphereBatchKernel sphere_batch_kernel(SimdLevel simd) {
+#ifdef RT_SPHERE_BATCH_X86
+    if (simd == SimdLevel::AVX2) return intersect_spheres_avx2;
+    if (simd == SimdLevel::SSE)  return intersect_spheres_sse;
+#endif
+    return intersect_spheres_scalar;
+}
@@ -0,0 +1,150 @@
+#include "TileScheduler.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+#include <thread>
+
+namespace {
+    // Чередование битов x и y (Z-кривая)
+    uint32_t morton_2d(uint32_t x, uint32_t y) {
+        auto spread = [](uint32_t v) {
+            v &= 0x0000FFFFu;
+            v = (v | (v << 8)) & 0x00FF00FFu;
+            v = (v | (v << 4)) & 0x0F0F0F0Fu;
+            v = (v | (v << 2)) & 0x33333333u;
+            v = (v | (v << 1)) & 0x55555555u;
+            return v;
+        };
+        return spread(x) | (spread(y) << 1);
+    }
+}
+
+TileScheduler::TileScheduler(int width, int height, const TileSchedulerOptions& options)
+    : workers(std::max(options.thread_count, 1))
+{
+    const int size = std::max(options.tile_size, 1);
+    const int nx   = (width  + size - 1) / size;
+    const int ny   = (height + size - 1) / size;
+
+    struct Keyed {
+        double key0, key1;
+        Tile   tile;
+    };
+    std::vector<Keyed> keyed;
+    keyed.reserve(size_t(nx) * ny);
+
+    for (int ty = 0; ty < ny; ++ty) {
+        for (int tx = 0; tx < nx; ++tx) {
+            Tile t{ tx * size, ty * size,
+                    std::min((tx + 1) * size, width),
+                    std::min((ty + 1) * size, height) };
+            // строки изображения идут снизу вверх, сверху — старшие j
+            int    row = ny - 1 - ty;
+            double dx  = tx - (nx - 1) * 0.5;
+            double dy  = ty - (ny - 1) * 0.5;
+            switch (options.order) {
+            case TileOrder::Scanline:
+                keyed.push_back({ double(row), double(tx), t });
+                break;
+            case TileOrder::Morton:
+                keyed.push_back({ double(morton_2d(tx, row)), 0.0, t });
+                break;
+            case TileOrder::Spiral:
+                keyed.push_back({ std::max(std::fabs(dx), std::fabs(dy)),
+                                  std::atan2(dy, dx), t });
+                break;
+            }
+        }
+    }
+    std::stable_sort(keyed.begin(), keyed.end(), [](const Keyed& a, const Keyed& b) {
+        return a.key0 < b.key0 || (a.key0 == b.key0 && a.key1 < b.key1);
+    });
+
+    tile_list.reserve(keyed.size());
+    for (const auto& k : keyed) tile_list.push_back(k.tile);
+
+    // Каждому потоку — непрерывный отрезок порядка: его тайлы лежат рядом
+    queues.reserve(workers);
+    for (int w = 0; w < workers; ++w) queues.push_back(std::make_unique<WorkQueue>());
+    const size_t n = tile_list.size();
+    for (size_t i = 0; i < n; ++i)
+        queues[i * workers / std::max<size_t>(n, 1)]->tiles.push_back(int(i));
+
+    worker_stats.assign(workers, WorkerStats{});
+}
+
+bool TileScheduler::pop_local(int worker, int& tile) {
+    WorkQueue& q = *queues[worker];
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if (q.tiles.empty()) return false;
+    tile = q.tiles.front();
+    q.tiles.pop_front();
+    return true;
+}
+
+bool TileScheduler::steal(int thief, int& tile) {
+    // Крадём с хвоста: это тайлы, до которых владелец дойдёт последним
+    for (int k = 1; k < workers; ++k) {
+        WorkQueue& q = *queues[(thief + k) % workers];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.tiles.empty()) continue;
+        tile = q.tiles.back();
+        q.tiles.pop_back();
+        return true;
+    }
+    return false;
+}
+
+void TileScheduler::run(const std::function<void(const Tile&, int)>& render_tile) {
+    using clock = std::chrono::steady_clock;
+    auto start = clock::now();
+
+    auto worker_main = [&](int w) {
+        WorkerStats& st = worker_stats[w];
+        while (true) {
+            int  tile;
+            bool stolen = false;
+            if (!pop_local(w, tile)) {
+                if (!steal(w, tile)) break;
+                stolen = true;
+            }
+            auto t0 = clock::now();
+            render_tile(tile_list[tile], w);
+            st.busy_seconds += std::chrono::duration<double>(clock::now() - t0).count();
+            ++st.tiles;
+            if (stolen) ++st.stolen;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(workers);
+    for (int w = 0; w < workers; ++w)
+        threads.emplace_back(worker_main, w);
+    for (auto& th : threads) th.join();
+
+    // Простой — всё, что поток не рендерил, пока рендерили остальные
+    double total = std::chrono::duration<double>(clock::now() - start).count();
+    for (auto& st : worker_stats)
+        st.idle_seconds = std::max(0.0, total - st.busy_seconds);
+}
+
+void TileScheduler::print_stats(std::ostream& out) const {
+    double busy = 0.0, idle = 0.0;
+    out << "Tiles: " << tile_list.size() << ", threads: " << workers << "\n";
+    for (int w = 0; w < workers; ++w) {
+        const WorkerStats& st = worker_stats[w];
+        busy += st.busy_seconds;
+        idle += st.idle_seconds;
+        out << "  thread " << std::setw(3) << w
+            << ": busy " << std::fixed << std::setprecision(2) << st.busy_seconds << "s"
+            << ", idle " << st.idle_seconds << "s"
+            << ", tiles " << st.tiles << " (stolen " << st.stolen << ")\n";
+    }
+    if (busy + idle > 0.0)
+        out << "  utilization: " << std::setprecision(1)
+            << 100.0 * busy / (busy + idle) << "%\n";
+}
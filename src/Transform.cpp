@@ -0,0 +1,145 @@
+#include "Transform.h"
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+namespace {
+    void set_identity(Real a[3][4]) {
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 4; ++j)
+                a[i][j] = i == j ? 1.0 : 0.0;
+    }
+
+    // c = a * b для аффинных 3×4 (нижняя строка неявно 0 0 0 1)
+    void multiply(const Real a[3][4], const Real b[3][4], Real c[3][4]) {
+        for (int i = 0; i < 3; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                Real s = a[i][0] * b[0][j] + a[i][1] * b[1][j] + a[i][2] * b[2][j];
+                c[i][j] = j == 3 ? s + a[i][3] : s;
+            }
+        }
+    }
+
+    // обратная аффинная: линейная часть — через присоединённую матрицу,
+    // сдвиг — -A^-1 * t
+    bool invert(const Real a[3][4], Real r[3][4]) {
+        Real c00 = a[1][1]*a[2][2] - a[1][2]*a[2][1];
+        Real c01 = a[1][2]*a[2][0] - a[1][0]*a[2][2];
+        Real c02 = a[1][0]*a[2][1] - a[1][1]*a[2][0];
+        Real det = a[0][0]*c00 + a[0][1]*c01 + a[0][2]*c02;
+        if (det == 0.0 || !std::isfinite(det))
+            return false;
+        Real inv_det = 1.0 / det;
+        r[0][0] = c00 * inv_det;
+        r[0][1] = (a[0][2]*a[2][1] - a[0][1]*a[2][2]) * inv_det;
+        r[0][2] = (a[0][1]*a[1][2] - a[0][2]*a[1][1]) * inv_det;
+        r[1][0] = c01 * inv_det;
+        r[1][1] = (a[0][0]*a[2][2] - a[0][2]*a[2][0]) * inv_det;
+        r[1][2] = (a[0][2]*a[1][0] - a[0][0]*a[1][2]) * inv_det;
+        r[2][0] = c02 * inv_det;
+        r[2][1] = (a[0][1]*a[2][0] - a[0][0]*a[2][1]) * inv_det;
+        r[2][2] = (a[0][0]*a[1][1] - a[0][1]*a[1][0]) * inv_det;
+        for (int i = 0; i < 3; ++i)
+            r[i][3] = -(r[i][0]*a[0][3] + r[i][1]*a[1][3] + r[i][2]*a[2][3]);
+        return true;
+    }
+}
+
+Transform::Transform() {
+    set_identity(m);
+    set_identity(m_inv);
+}
+
+Transform::Transform(const Real linear[3][3], const Vec3& offset) {
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j)
+            m[i][j] = linear[i][j];
+        m[i][3] = offset[i];
+    }
+    if (!invert(m, m_inv)) {
+        std::cerr << "Transform is not invertible.\n";
+        set_identity(m_inv);
+    }
+}
+
+Transform Transform::translate(const Vec3& offset) {
+    const Real id[3][3] = { {1,0,0}, {0,1,0}, {0,0,1} };
+    return Transform(id, offset);
+}
+
+Transform Transform::scale(const Vec3& f) {
+    const Real s[3][3] = { {f.x,0,0}, {0,f.y,0}, {0,0,f.z} };
+    return Transform(s, Vec3(0,0,0));
+}
+
+Transform Transform::scale(Real factor) {
+    return scale(Vec3(factor, factor, factor));
+}
+
+Transform Transform::rotate(Real degrees, const Vec3& axis) {
+    // формула Родрига
+    Vec3   a = unit_vector(axis);
+    Real   theta = degrees * M_PI / 180.0;
+    Real   s = std::sin(theta), c = std::cos(theta), k = 1.0 - c;
+    const Real r[3][3] = {
+        { a.x*a.x*k + c,     a.x*a.y*k - a.z*s, a.x*a.z*k + a.y*s },
+        { a.y*a.x*k + a.z*s, a.y*a.y*k + c,     a.y*a.z*k - a.x*s },
+        { a.z*a.x*k - a.y*s, a.z*a.y*k + a.x*s, a.z*a.z*k + c     }
+    };
+    return Transform(r, Vec3(0,0,0));
+}
+
+Transform Transform::operator*(const Transform& other) const {
+    Transform result;
+    multiply(m, other.m, result.m);
+    multiply(other.m_inv, m_inv, result.m_inv);
+    return result;
+}
+
+Transform Transform::inverse() const {
+    Transform result;
+    std::memcpy(result.m,     m_inv, sizeof(m));
+    std::memcpy(result.m_inv, m,     sizeof(m));
+    return result;
+}
+
+Point3 Transform::point(const Point3& p) const {
+    return Point3(m[0][0]*p.x + m[0][1]*p.y + m[0][2]*p.z + m[0][3],
+                  m[1][0]*p.x + m[1][1]*p.y + m[1][2]*p.z + m[1][3],
+                  m[2][0]*p.x + m[2][1]*p.y + m[2][2]*p.z + m[2][3]);
+}
+
+Vec3 Transform::vector(const Vec3& v) const {
+    return Vec3(m[0][0]*v.x + m[0][1]*v.y + m[0][2]*v.z,
+                m[1][0]*v.x + m[1][1]*v.y + m[1][2]*v.z,
+                m[2][0]*v.x + m[2][1]*v.y + m[2][2]*v.z);
+}
+
+Vec3 Transform::normal(const Vec3& n) const {
+    return Vec3(m_inv[0][0]*n.x + m_inv[1][0]*n.y + m_inv[2][0]*n.z,
+                m_inv[0][1]*n.x + m_inv[1][1]*n.y + m_inv[2][1]*n.z,
+                m_inv[0][2]*n.x + m_inv[1][2]*n.y + m_inv[2][2]*n.z);
+}
+
+Point3 Transform::inverse_point(const Point3& p) const {
+    return Point3(m_inv[0][0]*p.x + m_inv[0][1]*p.y + m_inv[0][2]*p.z + m_inv[0][3],
+                  m_inv[1][0]*p.x + m_inv[1][1]*p.y + m_inv[1][2]*p.z + m_inv[1][3],
+                  m_inv[2][0]*p.x + m_inv[2][1]*p.y + m_inv[2][2]*p.z + m_inv[2][3]);
+}
+
+Vec3 Transform::inverse_vector(const Vec3& v) const {
+    return Vec3(m_inv[0][0]*v.x + m_inv[0][1]*v.y + m_inv[0][2]*v.z,
+                m_inv[1][0]*v.x + m_inv[1][1]*v.y + m_inv[1][2]*v.z,
+                m_inv[2][0]*v.x + m_inv[2][1]*v.y + m_inv[2][2]*v.z);
+}
+
+AABB Transform::box(const AABB& b) const {
+    AABB result = AABB::empty();
+    for (int corner = 0; corner < 8; ++corner) {
+        Point3 p((corner & 1) ? b.maximum.x : b.minimum.x,
+                 (corner & 2) ? b.maximum.y : b.minimum.y,
+                 (corner & 4) ? b.maximum.z : b.minimum.z);
+        result.expand(point(p));
+    }
+    return result;
+}
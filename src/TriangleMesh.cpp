@@ -0,0 +1,225 @@
+#include "TriangleMesh.h"
+#include "Parallel.h"
+#include <cmath>
+#include <type_traits>
+#include <utility>
+
+namespace {
+    // Преобразование луча для водонепроницаемого теста: ось kz — самая
+    // длинная компонента направления, сдвиг S переводит луч в +z
+    struct WatertightRay {
+        int    kx, ky, kz;
+        Real   sx, sy, sz;
+
+        explicit WatertightRay(const Vec3& dir) {
+            Real ax = std::fabs(dir.x), ay = std::fabs(dir.y), az = std::fabs(dir.z);
+            kz = ax > ay ? (ax > az ? 0 : 2) : (ay > az ? 1 : 2);
+            kx = (kz + 1) % 3;
+            ky = (kx + 1) % 3;
+            // сохраняем ориентацию треугольника
+            if (dir[kz] < 0.0) std::swap(kx, ky);
+            sx = dir[kx] / dir[kz];
+            sy = dir[ky] / dir[kz];
+            sz = 1.0 / dir[kz];
+        }
+    };
+
+    /**
+     * Пересечение с треугольником (v0, v1, v2). При попадании в (t_min, t_max)
+     * возвращает t и барицентрические веса b0, b1, b2 вершин.
+     */
+    inline bool intersect_triangle(
+        const Ray& r, const WatertightRay& w,
+        const Point3& v0, const Point3& v1, const Point3& v2,
+        Real t_min, Real t_max,
+        Real& t, Real& b0, Real& b1, Real& b2
+    ) {
+        const Vec3 a = v0 - r.origin;
+        const Vec3 b = v1 - r.origin;
+        const Vec3 c = v2 - r.origin;
+
+        const Real ax = a[w.kx] - w.sx * a[w.kz];
+        const Real ay = a[w.ky] - w.sy * a[w.kz];
+        const Real bx = b[w.kx] - w.sx * b[w.kz];
+        const Real by = b[w.ky] - w.sy * b[w.kz];
+        const Real cx = c[w.kx] - w.sx * c[w.kz];
+        const Real cy = c[w.ky] - w.sy * c[w.kz];
+
+        // рёберные функции; точка на ребре засчитывается обоим соседям
+        Real u = cx * by - cy * bx;
+        Real v = ax * cy - ay * cx;
+        Real e = bx * ay - by * ax;
+        if constexpr (!std::is_same_v<Real, double>) {
+            // во float ноль может быть следствием округления: пересчёт в double
+            if (u == 0 || v == 0 || e == 0) {
+                u = Real(double(cx) * by - double(cy) * bx);
+                v = Real(double(ax) * cy - double(ay) * cx);
+                e = Real(double(bx) * ay - double(by) * ax);
+            }
+        }
+        if ((u < 0.0 || v < 0.0 || e < 0.0) && (u > 0.0 || v > 0.0 || e > 0.0))
+            return false;
+
+        const Real det = u + v + e;
+        if (det == 0.0)
+            return false;
+
+        const Real az = w.sz * a[w.kz];
+        const Real bz = w.sz * b[w.kz];
+        const Real cz = w.sz * c[w.kz];
+        const Real inv_det = 1.0 / det;
+        t = (u * az + v * bz + e * cz) * inv_det;
+        if (t <= t_min || t >= t_max)
+            return false;
+
+        b0 = u * inv_det;
+        b1 = v * inv_det;
+        b2 = e * inv_det;
+        return true;
+    }
+}
+
+TriangleMesh::TriangleMesh(
+    std::vector<Point3> positions_in,
+    std::vector<uint32_t> indices_in,
+    std::shared_ptr<Material> material,
+    std::vector<Vec3> normals_in,
+    std::vector<UV> uvs_in,
+    const ParallelBVHOptions& options
+)
+    : positions(std::move(positions_in))
+    , normals(std::move(normals_in))
+    , uvs(std::move(uvs_in))
+    , mat_ptr(std::move(material))
+    , box(AABB::empty())
+{
+    if (normals.size() != positions.size()) normals.clear();
+    if (uvs.size()     != positions.size()) uvs.clear();
+
+    const size_t tri_count = indices_in.size() / 3;
+    std::vector<BVHPrimitiveInfo> prims(tri_count);
+    parallel_for(tri_count, options.thread_count, [&](size_t i) {
+        AABB b = AABB::empty();
+        for (int k = 0; k < 3; ++k)
+            b.expand(positions[indices_in[3*i + k]]);
+        prims[i].box      = b;
+        prims[i].centroid = b.centroid();
+    }, 4096);
+    for (const auto& p : prims)
+        box.expand(p.box);
+
+    // листья BVH ссылаются на треугольники подряд: переставляем индексы
+    // в порядке листьев, отдельный массив порядка не нужен
+    std::vector<uint32_t> order;
+    build_linear_bvh_parallel(prims, options, nodes, order);
+    indices.resize(tri_count * 3);
+    for (size_t i = 0; i < order.size(); ++i)
+        for (int k = 0; k < 3; ++k)
+            indices[3*i + k] = indices_in[3*size_t(order[i]) + k];
+}
+
+bool TriangleMesh::intersect(
+    const Ray& r,
+    Real t_min,
+    Real t_max,
+    Intersection& isect
+) const {
+    if (nodes.empty())
+        return false;
+
+    const WatertightRay w(r.direction);
+    uint32_t best = 0;
+    Real     best_b0 = 0, best_b1 = 0, best_b2 = 0;
+    bool hit_anything = traverse_linear_bvh(nodes.data(), r, t_min, t_max,
+        [&](uint32_t first, uint32_t count, Real& closest) {
+            bool found = false;
+            for (uint32_t tri = first; tri < first + count; ++tri) {
+                const uint32_t* idx = &indices[3 * size_t(tri)];
+                Real t, b0, b1, b2;
+                if (intersect_triangle(r, w, positions[idx[0]], positions[idx[1]], positions[idx[2]],
+                                       t_min, closest, t, b0, b1, b2)) {
+                    closest = t;
+                    best    = tri;
+                    best_b0 = b0;
+                    best_b1 = b1;
+                    best_b2 = b2;
+                    found   = true;
+                }
+            }
+            return found;
+        });
+    if (!hit_anything)
+        return false;
+    isect.set(t_max, this, best, best_b0, best_b1, best_b2);
+    return true;
+}
+
+void TriangleMesh::surface(
+    const Ray& r,
+    const Intersection& isect,
+    HitRecord& rec
+) const {
+    // атрибуты поверхности — только для ближайшего попадания
+    const uint32_t* idx = &indices[3 * size_t(isect.prim)];
+    const Point3& p0 = positions[idx[0]];
+    const Point3& p1 = positions[idx[1]];
+    const Point3& p2 = positions[idx[2]];
+    const Real best_b0 = isect.b0, best_b1 = isect.b1, best_b2 = isect.b2;
+    rec.t       = isect.t;
+    rec.p       = r.at(isect.t);
+    rec.mat_ptr = mat_ptr.get();
+
+    Vec3 geometric = unit_vector(cross(p1 - p0, p2 - p0));
+    if (!normals.empty()) {
+        Vec3 shading = unit_vector(best_b0 * normals[idx[0]]
+                                 + best_b1 * normals[idx[1]]
+                                 + best_b2 * normals[idx[2]]);
+        // «наружу» задают нормали вершин, а не порядок обхода вершин;
+        // сторона попадания — по геометрической нормали
+        if (dot(geometric, shading) < 0.0)
+            geometric = -geometric;
+        rec.set_face_normal(r, geometric);
+        rec.normal = rec.front_face ? shading : -shading;
+    } else {
+        rec.set_face_normal(r, geometric);
+    }
+    if (!uvs.empty()) {
+        rec.u = best_b0 * uvs[idx[0]].u + best_b1 * uvs[idx[1]].u + best_b2 * uvs[idx[2]].u;
+        rec.v = best_b0 * uvs[idx[0]].v + best_b1 * uvs[idx[1]].v + best_b2 * uvs[idx[2]].v;
+    } else {
+        rec.u = best_b1;
+        rec.v = best_b2;
+    }
+}
+
+bool TriangleMesh::occluded(
+    const Ray& r,
+    Real t_min,
+    Real t_max
+) const {
+    if (nodes.empty())
+        return false;
+
+    const WatertightRay w(r.direction);
+    return traverse_linear_bvh<true>(nodes.data(), r, t_min, t_max,
+        [&](uint32_t first, uint32_t count, Real&) {
+            for (uint32_t tri = first; tri < first + count; ++tri) {
+                const uint32_t* idx = &indices[3 * size_t(tri)];
+                Real t, b0, b1, b2;
+                if (intersect_triangle(r, w, positions[idx[0]], positions[idx[1]], positions[idx[2]],
+                                       t_min, t_max, t, b0, b1, b2))
+                    return true;
+            }
+            return false;
+        });
+}
+
+bool TriangleMesh::bounding_box(
+    Real time0,
+    Real time1,
+    AABB& output_box
+) const {
+    if (nodes.empty()) return false;
+    output_box = box;
+    return true;
+}
@@ -0,0 +1,257 @@
+#include "Wavefront.h"
+#include "Material.h"
+#include <algorithm>
+#include <type_traits>
+#include <typeinfo>
+
+namespace {
+    constexpr int OCTANT_COUNT = 8;
+    constexpr int KEY_COUNT    = MATERIAL_KIND_COUNT * OCTANT_COUNT;
+
+    // октант направления: знаки компонент, уже посчитанные в Ray
+    inline int octant(const Ray& r) {
+        return r.sign[0] | (r.sign[1] << 1) | (r.sign[2] << 2);
+    }
+
+    // Вызовы материала известного типа — без виртуальной диспетчеризации;
+    // для Material (тип Other) — обычные виртуальные
+    template <typename M>
+    Color emitted_as(const Material* mat) {
+        if constexpr (std::is_same_v<M, Material>)
+            return mat->emitted();
+        else
+            return static_cast<const M*>(mat)->M::emitted();
+    }
+
+    template <typename M>
+    bool scatter_as(const Material* mat, const Ray& r, const HitRecord& rec, ScatterRecord& srec) {
+        if constexpr (std::is_same_v<M, Material>)
+            return mat->scatter(r, rec, srec);
+        else
+            return static_cast<const M*>(mat)->M::scatter(r, rec, srec);
+    }
+}
+
+MaterialKind material_kind(const Material* mat) {
+    // точное совпадение типа: наследник может переопределить scatter/emitted
+    const std::type_info& type = typeid(*mat);
+    if (type == typeid(Lambertian))   return MaterialKind::Lambertian;
+    if (type == typeid(Metal))        return MaterialKind::Metal;
+    if (type == typeid(Dielectric))   return MaterialKind::Dielectric;
+    if (type == typeid(DiffuseLight)) return MaterialKind::DiffuseLight;
+    return MaterialKind::Other;
+}
+
+WavefrontIntegrator::WavefrontIntegrator(
+    const Hittable& world,
+    const IntegratorSettings& settings,
+    int packet_size
+)
+    : world(world), settings(settings)
+    , packet_size(std::clamp(packet_size, 1, RAY_PACKET_MAX))
+{}
+
+void WavefrontIntegrator::trace(
+    const Ray* rays,
+    const Sampler::State* states,
+    int count,
+    Sampler& sampler,
+    Color* colors
+) {
+    paths.clear();
+    for (int k = 0; k < count; ++k) {
+        paths.push_back({ rays[k], Color(1,1,1), states[k], k, false });
+        colors[k] = Color(0,0,0);   // оборванный путь ничего не приносит
+    }
+
+    // все пути волны стартовали вместе — номер отскока у них общий
+    for (int bounce = 0; bounce < settings.max_depth && !paths.empty(); ++bounce) {
+        trace_rays();
+        sort_hits(colors);
+        shade_hits(sampler, colors);
+        trace_ao();
+        finish_bounce(bounce, sampler);
+    }
+}
+
+void WavefrontIntegrator::trace_rays() {
+    const int count = int(paths.size());
+    hits.resize(count);
+    found.assign(count, 0);
+    if (packet_size == 1) {
+        for (int k = 0; k < count; ++k) {
+            const Ray& r = paths[k].ray;
+            found[k] = world.hit(r, surface_t_min(r), REAL_INFINITY, hits[k]);
+        }
+        return;
+    }
+
+    // соседние пути очереди идут в одном октанте (finish_bounce) —
+    // пакеты по packet_size лучей
+    for (int first = 0; first < count; first += packet_size) {
+        const int n = std::min(packet_size, count - first);
+        RayPacket packet;
+        for (int k = 0; k < n; ++k) {
+            const Ray& r = paths[first + k].ray;
+            packet.add(r, surface_t_min(r), REAL_INFINITY);
+        }
+        uint32_t mask = world.hit_packet(packet, packet.all(), &hits[first]);
+        for (; mask; mask &= mask - 1)
+            found[first + __builtin_ctz(mask)] = 1;
+    }
+}
+
+void WavefrontIntegrator::sort_hits(Color* colors) {
+    // промахи завершают путь фоном; попадания — сортировка подсчётом
+    // по (тип материала, октант входящего луча)
+    const int count = int(paths.size());
+    keys.resize(count);
+    group_start.assign(KEY_COUNT + 1, 0);
+    for (int k = 0; k < count; ++k) {
+        const PathState& path = paths[k];
+        if (!found[k]) {
+            colors[path.index] = path.throughput * background(path.ray);
+            continue;
+        }
+        keys[k] = uint16_t(int(material_kind(hits[k].mat_ptr)) * OCTANT_COUNT + octant(path.ray));
+        ++group_start[keys[k] + 1];
+    }
+    for (int g = 0; g < KEY_COUNT; ++g)
+        group_start[g + 1] += group_start[g];
+
+    order.resize(group_start[KEY_COUNT]);
+    uint32_t fill[KEY_COUNT];
+    std::copy_n(group_start.begin(), KEY_COUNT, fill);
+    for (int k = 0; k < count; ++k)
+        if (found[k])
+            order[fill[keys[k]]++] = uint32_t(k);
+}
+
+void WavefrontIntegrator::shade_hits(Sampler& sampler, Color* colors) {
+    alive.assign(paths.size(), 0);
+    ao_jobs.assign(paths.size(), AOJob{ 0, 0, 0 });
+    ao_packets.clear();
+
+    // каждая группа одного типа материала — своим циклом
+    for (int kind = 0; kind < MATERIAL_KIND_COUNT; ++kind) {
+        const uint32_t* begin = order.data() + group_start[kind * OCTANT_COUNT];
+        const uint32_t* end   = order.data() + group_start[(kind + 1) * OCTANT_COUNT];
+        if (begin == end)
+            continue;
+        switch (MaterialKind(kind)) {
+        case MaterialKind::Lambertian:   shade_group<Lambertian>(begin, end, sampler, colors);   break;
+        case MaterialKind::Metal:        shade_group<Metal>(begin, end, sampler, colors);        break;
+        case MaterialKind::Dielectric:   shade_group<Dielectric>(begin, end, sampler, colors);   break;
+        case MaterialKind::DiffuseLight: shade_group<DiffuseLight>(begin, end, sampler, colors); break;
+        case MaterialKind::Other:        shade_group<Material>(begin, end, sampler, colors);     break;
+        }
+    }
+}
+
+template <typename M>
+void WavefrontIntegrator::shade_group(
+    const uint32_t* begin,
+    const uint32_t* end,
+    Sampler& sampler,
+    Color* colors
+) {
+    const AOSettings& ao = settings.ao;
+    const int ao_packet  = std::clamp(ao.packet_size, 1, RAY_PACKET_MAX);
+    for (const uint32_t* it = begin; it != end; ++it) {
+        PathState&       path = paths[*it];
+        const HitRecord& rec  = hits[*it];
+        const Material*  mat  = rec.mat_ptr;
+
+        // 1) Эмиссия завершает путь
+        Color emitted = emitted_as<M>(mat);
+        if (emitted.x>0 || emitted.y>0 || emitted.z>0) {
+            colors[path.index] = path.throughput * emitted;
+            continue;
+        }
+
+        // 2) Scatter — пробы этого пути
+        sampler.restore_state(path.sampler);
+        ScatterRecord srec;
+        if (!scatter_as<M>(mat, path.ray, rec, srec))
+            continue;
+        path.throughput = path.throughput * srec.attenuation;
+
+        // 3) AO: лучи генерируются сейчас (пробы — в прежнем порядке),
+        //    трассируются все вместе в trace_ao
+        if (!srec.is_specular) {
+            bool want_ao = settings.ao_mode == AOMode::EveryBounce
+                        || (settings.ao_mode == AOMode::FirstDiffuse && !path.ao_done);
+            if (want_ao && ao.samples > 0) {
+                AOJob& job = ao_jobs[*it];
+                job.first_packet = int(ao_packets.size());
+                const Point3 origin = offset_ray_origin(rec.p, rec.normal);
+                for (int i = 0; i < ao.samples; i += ao_packet) {
+                    ao_packets.emplace_back();
+                    RayPacket& packet = ao_packets.back();
+                    for (int k = i; k < std::min(i + ao_packet, ao.samples); ++k) {
+                        Ray ao_ray(origin, sample_hemisphere(rec.normal, sample_2d()));
+                        packet.add(ao_ray, surface_t_min(ao_ray), ao.max_distance);
+                    }
+                }
+                job.packets = int(ao_packets.size()) - job.first_packet;
+            }
+            path.ao_done = true;
+        }
+
+        path.sampler = sampler.save_state();
+        path.ray     = srec.specular_ray;
+        alive[*it]   = 1;
+    }
+}
+
+void WavefrontIntegrator::trace_ao() {
+    for (AOJob& job : ao_jobs) {
+        for (int p = job.first_packet; p < job.first_packet + job.packets; ++p) {
+            const RayPacket& packet = ao_packets[p];
+            if (packet.count == 1)   // ao.packet_size 1: луч без пакета
+                job.occluded += world.occluded(packet.rays[0], packet.t_min[0], packet.t_max[0]);
+            else
+                job.occluded += __builtin_popcount(world.occluded_packet(packet, packet.all()));
+        }
+    }
+}
+
+void WavefrontIntegrator::finish_bounce(int bounce, Sampler& sampler) {
+    // AO и русская рулетка; выжившие — в следующую очередь, по октанту
+    // нового луча, чтобы пакеты trace_rays были когерентнее
+    uint32_t octant_start[OCTANT_COUNT + 1] = {};
+    const int count = int(paths.size());
+    for (int k = 0; k < count; ++k) {
+        if (!alive[k])
+            continue;
+        PathState& path = paths[k];
+        if (ao_jobs[k].packets > 0)
+            path.throughput *= 1.0 - Real(ao_jobs[k].occluded) / settings.ao.samples;
+
+        if (bounce + 1 >= settings.rr_depth) {
+            Real p = std::min(std::max({ path.throughput.x, path.throughput.y, path.throughput.z }),
+                              settings.rr_max_survival);
+            if (p <= 0.0) {
+                alive[k] = 0;
+                continue;
+            }
+            sampler.restore_state(path.sampler);
+            bool survives = sample_1d() < p;
+            path.sampler  = sampler.save_state();
+            if (!survives) {
+                alive[k] = 0;
+                continue;
+            }
+            path.throughput /= p;
+        }
+        ++octant_start[octant(path.ray) + 1];
+    }
+    for (int o = 0; o < OCTANT_COUNT; ++o)
+        octant_start[o + 1] += octant_start[o];
+
+    next_paths.resize(octant_start[OCTANT_COUNT]);
+    for (int k = 0; k < count; ++k)
+        if (alive[k])
+            next_paths[octant_start[octant(paths[k].ray)]++] = paths[k];
+    paths.swap(next_paths);
+}
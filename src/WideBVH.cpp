@@ -0,0 +1,573 @@
+#include "WideBVH.h"
+#include "ParallelBVH.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <limits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define RT_WIDE_BVH_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+    // Луч для slab-тестов во float. near_plane/far_plane — строки bounds
+    // узла с ближней и дальней гранью по каждой оси (выбор по знаку)
+    struct WideRay {
+        float origin[3];
+        float inv_dir[3];
+        int   near_plane[3];
+        int   far_plane[3];
+
+        WideRay() = default;
+        explicit WideRay(const Ray& r) {
+            for (int a = 0; a < 3; ++a) {
+                origin[a]     = static_cast<float>(r.origin[a]);
+                inv_dir[a]    = static_cast<float>(r.inv_direction[a]);
+                near_plane[a] = r.sign[a] ? a + 3 : a;
+                far_plane[a]  = r.sign[a] ? a     : a + 3;
+            }
+        }
+    };
+
+    // Скалярный slab-тест всех W детей; dist — дистанции входа
+    template <int W>
+    int intersect_scalar(
+        const WideBVHNode<W>& node, const WideRay& ray,
+        float t_min, float t_max, float* dist
+    ) {
+        int mask = 0;
+        for (int i = 0; i < W; ++i) {
+            float tn = t_min;
+            float tf = t_max;
+            for (int a = 0; a < 3; ++a) {
+                float t0 = (node.bounds[ray.near_plane[a]][i] - ray.origin[a]) * ray.inv_dir[a];
+                float t1 = (node.bounds[ray.far_plane[a]][i]  - ray.origin[a]) * ray.inv_dir[a];
+                tn = t0 > tn ? t0 : tn;
+                tf = t1 < tf ? t1 : tf;
+            }
+            dist[i] = tn;
+            if (tn <= tf) mask |= 1 << i;
+        }
+        return mask;
+    }
+
+#ifdef RT_WIDE_BVH_X86
+    // max/min возвращают второй операнд, если первый NaN (0 * inf),
+    // поэтому такая ось не сужает интервал — как и в скалярной версии
+    __attribute__((target("sse2")))
+    int intersect_sse(
+        const WideBVHNode<4>& node, const WideRay& ray,
+        float t_min, float t_max, float* dist
+    ) {
+        __m128 tn = _mm_set1_ps(t_min);
+        __m128 tf = _mm_set1_ps(t_max);
+        for (int a = 0; a < 3; ++a) {
+            __m128 o   = _mm_set1_ps(ray.origin[a]);
+            __m128 inv = _mm_set1_ps(ray.inv_dir[a]);
+            __m128 t0  = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.bounds[ray.near_plane[a]]), o), inv);
+            __m128 t1  = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.bounds[ray.far_plane[a]]),  o), inv);
+            tn = _mm_max_ps(t0, tn);
+            tf = _mm_min_ps(t1, tf);
+        }
+        _mm_storeu_ps(dist, tn);
+        return _mm_movemask_ps(_mm_cmple_ps(tn, tf));
+    }
+
+    __attribute__((target("avx2")))
+    int intersect_avx2(
+        const WideBVHNode<8>& node, const WideRay& ray,
+        float t_min, float t_max, float* dist
+    ) {
+        __m256 tn = _mm256_set1_ps(t_min);
+        __m256 tf = _mm256_set1_ps(t_max);
+        for (int a = 0; a < 3; ++a) {
+            __m256 o   = _mm256_set1_ps(ray.origin[a]);
+            __m256 inv = _mm256_set1_ps(ray.inv_dir[a]);
+            __m256 t0  = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(node.bounds[ray.near_plane[a]]), o), inv);
+            __m256 t1  = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(node.bounds[ray.far_plane[a]]),  o), inv);
+            tn = _mm256_max_ps(t0, tn);
+            tf = _mm256_min_ps(t1, tf);
+        }
+        _mm256_storeu_ps(dist, tn);
+        return _mm256_movemask_ps(_mm256_cmp_ps(tn, tf, _CMP_LE_OQ));
+    }
+#endif
+
+    template <int W>
+    using WideKernel = int (*)(const WideBVHNode<W>&, const WideRay&, float, float, float*);
+
+    /**
+     * Обход широкого BVH: все дети узла проверяются одним вызовом kernel,
+     * листья — сразу по возрастанию дистанции, внутренние узлы уходят
+     * в стек так, чтобы ближний снимался первым. При AnyHit обход
+     * заканчивается на первом листе с попаданием.
+     */
+    template <int W, WideKernel<W> Kernel, bool AnyHit, typename LeafFn>
+    bool traverse_wide(
+        const WideBVHNode<W>* nodes,
+        const Ray& r,
+        Real t_min,
+        Real& t_max,
+        LeafFn&& leaf
+    ) {
+        struct StackEntry {
+            uint32_t node;
+            float    entry;
+        };
+        StackEntry stack[LINEAR_BVH_MAX_DEPTH * W];
+        int        sp = 0;
+
+        WideRay  ray(r);
+        float    tmin         = static_cast<float>(t_min);
+        bool     hit_anything = false;
+        uint32_t current      = 0;
+
+        while (true) {
+            const WideBVHNode<W>& node = nodes[current];
+            alignas(32) float dist[W];
+            int mask = Kernel(node, ray, tmin, static_cast<float>(t_max), dist);
+
+            int hits[W];
+            int n = 0;
+            for (; mask; mask &= mask - 1) {
+                int i = __builtin_ctz(mask);
+                int k = n++;
+                while (k > 0 && dist[hits[k - 1]] > dist[i]) {
+                    hits[k] = hits[k - 1];
+                    --k;
+                }
+                hits[k] = i;
+            }
+
+            for (int k = 0; k < n; ++k) {
+                int i = hits[k];
+                if (node.count[i] > 0 && dist[i] <= t_max
+                    && leaf(node.child[i], node.count[i], t_max)) {
+                    if (AnyHit) return true;
+                    hit_anything = true;
+                }
+            }
+            for (int k = n - 1; k >= 0; --k) {
+                int i = hits[k];
+                if (node.count[i] == 0 && dist[i] <= t_max)
+                    stack[sp++] = { node.child[i], dist[i] };
+            }
+
+            bool found = false;
+            while (sp > 0) {
+                StackEntry e = stack[--sp];
+                if (e.entry <= t_max) {
+                    current = e.node;
+                    found   = true;
+                    break;
+                }
+            }
+            if (!found) break;
+        }
+        return hit_anything;
+    }
+
+    /**
+     * Обход пакета лучей с общим стеком: узел читается один раз на пакет,
+     * и kernel проверяет его детей для каждого активного луча. В стек
+     * уходит ребёнок с маской лучей, попавших в его коробку, и наименьшей
+     * из их дистанций входа; дети — от ближнего к дальнему по этой
+     * дистанции. Закончившие лучи (AnyHit) и лучи, чей t_max ближе входа,
+     * выпадают из масок. leaf(k, first, count, t_max) — лист для луча k.
+     */
+    template <int W, WideKernel<W> Kernel, bool AnyHit, typename LeafFn>
+    uint32_t traverse_wide_packet(
+        const WideBVHNode<W>* nodes,
+        const RayPacket& packet,
+        uint32_t active,
+        Real* t_max,
+        LeafFn&& leaf
+    ) {
+        struct StackEntry {
+            uint32_t node;
+            uint32_t rays;
+            float    entry;
+        };
+        StackEntry stack[LINEAR_BVH_MAX_DEPTH * W];
+        int        sp = 0;
+
+        WideRay rays[RAY_PACKET_MAX];
+        float   tmin[RAY_PACKET_MAX];
+        for (uint32_t m = active; m; m &= m - 1) {
+            int k = __builtin_ctz(m);
+            rays[k] = WideRay(packet.rays[k]);
+            tmin[k] = static_cast<float>(packet.t_min[k]);
+        }
+
+        const float inf     = std::numeric_limits<float>::infinity();
+        uint32_t    hit_mask = 0;
+        uint32_t    current  = 0;
+        uint32_t    current_rays = active;
+
+        while (true) {
+            const WideBVHNode<W>& node = nodes[current];
+            uint32_t child_rays[W] = {};
+            float    child_entry[W];
+            std::fill(child_entry, child_entry + W, inf);
+            alignas(32) float dist[RAY_PACKET_MAX][W];
+            for (uint32_t m = current_rays; m; m &= m - 1) {
+                int k = __builtin_ctz(m);
+                int mask = Kernel(node, rays[k], tmin[k], static_cast<float>(t_max[k]), dist[k]);
+                for (; mask; mask &= mask - 1) {
+                    int i = __builtin_ctz(mask);
+                    child_rays[i] |= 1u << k;
+                    child_entry[i] = std::min(child_entry[i], dist[k][i]);
+                }
+            }
+
+            int hits[W];
+            int n = 0;
+            for (int i = 0; i < W; ++i) {
+                if (!child_rays[i]) continue;
+                int k = n++;
+                while (k > 0 && child_entry[hits[k - 1]] > child_entry[i]) {
+                    hits[k] = hits[k - 1];
+                    --k;
+                }
+                hits[k] = i;
+            }
+
+            for (int k = 0; k < n; ++k) {
+                int i = hits[k];
+                if (node.count[i] == 0) continue;
+                for (uint32_t m = child_rays[i] & active; m; m &= m - 1) {
+                    int ray = __builtin_ctz(m);
+                    if (dist[ray][i] > t_max[ray]
+                        || !leaf(ray, node.child[i], node.count[i], t_max[ray]))
+                        continue;
+                    hit_mask |= 1u << ray;
+                    if (AnyHit) active &= ~(1u << ray);
+                }
+            }
+            if (AnyHit && !active) break;
+            for (int k = n - 1; k >= 0; --k) {
+                int i = hits[k];
+                if (node.count[i] != 0) continue;
+                stack[sp++] = { node.child[i], child_rays[i], child_entry[i] };
+            }
+
+            bool found = false;
+            while (sp > 0) {
+                StackEntry e = stack[--sp];
+                uint32_t live = 0;
+                for (uint32_t m = e.rays & active; m; m &= m - 1) {
+                    int k = __builtin_ctz(m);
+                    if (e.entry <= t_max[k])
+                        live |= 1u << k;
+                }
+                if (live) {
+                    current      = e.node;
+                    current_rays = live;
+                    found        = true;
+                    break;
+                }
+            }
+            if (!found) break;
+        }
+        return hit_mask;
+    }
+
+    // То же для пакета: выбор ширины и SIMD-ядра — один раз на пакет
+    template <bool AnyHit, typename LeafFn>
+    uint32_t dispatch_wide_packet(
+        int width, SimdLevel simd,
+        const std::vector<WideBVHNode<4>>& nodes4,
+        const std::vector<WideBVHNode<8>>& nodes8,
+        const RayPacket& packet, uint32_t active, Real* t_max,
+        LeafFn&& leaf
+    ) {
+        if (width == 8) {
+#ifdef RT_WIDE_BVH_X86
+            if (simd == SimdLevel::AVX2)
+                return traverse_wide_packet<8, intersect_avx2, AnyHit>(nodes8.data(), packet, active, t_max, leaf);
+#endif
+            return traverse_wide_packet<8, intersect_scalar<8>, AnyHit>(nodes8.data(), packet, active, t_max, leaf);
+        }
+#ifdef RT_WIDE_BVH_X86
+        if (simd != SimdLevel::Scalar)
+            return traverse_wide_packet<4, intersect_sse, AnyHit>(nodes4.data(), packet, active, t_max, leaf);
+#endif
+        return traverse_wide_packet<4, intersect_scalar<4>, AnyHit>(nodes4.data(), packet, active, t_max, leaf);
+    }
+
+    // Выбор ширины и SIMD-ядра — один раз на луч
+    template <bool AnyHit, typename LeafFn>
+    bool dispatch_wide(
+        int width, SimdLevel simd,
+        const std::vector<WideBVHNode<4>>& nodes4,
+        const std::vector<WideBVHNode<8>>& nodes8,
+        const Ray& r, Real t_min, Real t_max,
+        LeafFn&& leaf
+    ) {
+        if (width == 8) {
+#ifdef RT_WIDE_BVH_X86
+            if (simd == SimdLevel::AVX2)
+                return traverse_wide<8, intersect_avx2, AnyHit>(nodes8.data(), r, t_min, t_max, leaf);
+#endif
+            return traverse_wide<8, intersect_scalar<8>, AnyHit>(nodes8.data(), r, t_min, t_max, leaf);
+        }
+#ifdef RT_WIDE_BVH_X86
+        if (simd != SimdLevel::Scalar)
+            return traverse_wide<4, intersect_sse, AnyHit>(nodes4.data(), r, t_min, t_max, leaf);
+#endif
+        return traverse_wide<4, intersect_scalar<4>, AnyHit>(nodes4.data(), r, t_min, t_max, leaf);
+    }
+
+    Real binary_node_area(const LinearBVHNode& node) {
+        Real dx = node.bounds_max[0] - node.bounds_min[0];
+        Real dy = node.bounds_max[1] - node.bounds_min[1];
+        Real dz = node.bounds_max[2] - node.bounds_min[2];
+        return 2.0 * (dx*dy + dy*dz + dz*dx);
+    }
+
+    template <int W>
+    void collapse_node(
+        const std::vector<LinearBVHNode>& binary,
+        std::vector<WideBVHNode<W>>& wide,
+        uint32_t bin_index,
+        uint32_t wide_index
+    ) {
+        // Набираем до W бинарных потомков, раскрывая самых крупных
+        uint32_t slots[W];
+        int      n = 0;
+        const LinearBVHNode& root = binary[bin_index];
+        if (root.is_leaf()) {
+            slots[n++] = bin_index;
+        } else {
+            slots[n++] = root.left_first;
+            slots[n++] = root.left_first + 1;
+            while (n < W) {
+                int    best      = -1;
+                Real   best_area = -1.0;
+                for (int k = 0; k < n; ++k) {
+                    const LinearBVHNode& c = binary[slots[k]];
+                    if (!c.is_leaf() && binary_node_area(c) > best_area) {
+                        best      = k;
+                        best_area = binary_node_area(c);
+                    }
+                }
+                if (best < 0) break;
+                uint32_t expanded = binary[slots[best]].left_first;
+                slots[best] = expanded;
+                slots[n++]  = expanded + 1;
+            }
+        }
+
+        const float inf = std::numeric_limits<float>::infinity();
+        WideBVHNode<W> node;
+        for (int i = 0; i < W; ++i) {
+            for (int a = 0; a < 3; ++a) {
+                node.bounds[a][i]     =  inf;
+                node.bounds[a + 3][i] = -inf;
+            }
+            node.child[i] = WIDE_BVH_EMPTY;
+            node.count[i] = 0;
+        }
+        for (int k = 0; k < n; ++k) {
+            const LinearBVHNode& c = binary[slots[k]];
+            for (int a = 0; a < 3; ++a) {
+                node.bounds[a][k]     = c.bounds_min[a];
+                node.bounds[a + 3][k] = c.bounds_max[a];
+            }
+            if (c.is_leaf()) {
+                node.child[k] = c.left_first;
+                node.count[k] = c.count;
+            }
+        }
+        wide[wide_index] = node;
+
+        for (int k = 0; k < n; ++k) {
+            if (binary[slots[k]].is_leaf()) continue;
+            uint32_t child = static_cast<uint32_t>(wide.size());
+            wide.emplace_back();
+            wide[wide_index].child[k] = child;
+            collapse_node<W>(binary, wide, slots[k], child);
+        }
+    }
+}
+
+template <int W>
+void collapse_linear_bvh(
+    const std::vector<LinearBVHNode>& binary,
+    std::vector<WideBVHNode<W>>& wide
+) {
+    wide.clear();
+    if (binary.empty()) return;
+    wide.reserve(binary.size() / 2 + 1);
+    wide.emplace_back();
+    collapse_node<W>(binary, wide, 0, 0);
+    wide.shrink_to_fit();
+}
+
+template void collapse_linear_bvh<4>(const std::vector<LinearBVHNode>&, std::vector<WideBVHNode<4>>&);
+template void collapse_linear_bvh<8>(const std::vector<LinearBVHNode>&, std::vector<WideBVHNode<8>>&);
+
+WideBVH::WideBVH(
+    const std::vector<HittablePtr>& src_objects,
+    Real time0,
+    Real time1,
+    const ParallelBVHOptions& options,
+    int width
+)
+    : simd(detect_simd_level())
+    , objects(src_objects)
+    , box(AABB::empty())
+{
+    std::vector<BVHPrimitiveInfo> prims(objects.size());
+    std::atomic<bool> missing_box{false};
+    parallel_for(objects.size(), options.thread_count, [&](size_t i) {
+        AABB b;
+        if (!objects[i]->bounding_box(time0, time1, b))
+            missing_box = true;
+        prims[i].box      = b;
+        prims[i].centroid = b.centroid();
+    }, 1024);
+    if (missing_box)
+        std::cerr << "No bounding box in WideBVH constructor.\n";
+
+    std::vector<LinearBVHNode> binary;
+    std::vector<uint32_t>      order;
+    build_linear_bvh_parallel(prims, options, binary, order);
+    init_from_binary(binary, order, width);
+
+    for (const auto& p : prims)
+        box.expand(p.box);
+}
+
+WideBVH::WideBVH(
+    const std::vector<HittablePtr>& src_objects,
+    const std::vector<LinearBVHNode>& binary,
+    const std::vector<uint32_t>& order,
+    int width
+)
+    : simd(detect_simd_level())
+    , objects(src_objects)
+    , box(AABB::empty())
+{
+    init_from_binary(binary, order, width);
+
+    // границы корня во float уже округлены наружу
+    if (!binary.empty()) {
+        const LinearBVHNode& root = binary[0];
+        box = AABB(Point3(root.bounds_min[0], root.bounds_min[1], root.bounds_min[2]),
+                   Point3(root.bounds_max[0], root.bounds_max[1], root.bounds_max[2]));
+    }
+}
+
+void WideBVH::init_from_binary(
+    const std::vector<LinearBVHNode>& binary,
+    const std::vector<uint32_t>& order,
+    int width
+) {
+    node_width = width == 4 || width == 8 ? width
+               : (simd == SimdLevel::AVX2 ? 8 : 4);
+
+    if (node_width == 8) collapse_linear_bvh<8>(binary, nodes8);
+    else                 collapse_linear_bvh<4>(binary, nodes4);
+
+    std::vector<uint32_t> leaf_order = order;
+    group_leaves_by_kind(binary, objects, leaf_order);
+    primitives.build(objects, leaf_order);
+    nesting = max_instance_nesting(objects);
+}
+
+bool WideBVH::intersect(
+    const Ray& r,
+    Real t_min,
+    Real t_max,
+    Intersection& isect
+) const {
+    if (empty())
+        return false;
+
+    auto leaf = [&](uint32_t first, uint32_t count, Real& closest) {
+        return primitives.intersect(first, count, r, t_min, closest, isect);
+    };
+
+    return dispatch_wide<false>(node_width, simd, nodes4, nodes8, r, t_min, t_max, leaf);
+}
+
+void WideBVH::surface(const Ray&, const Intersection&, HitRecord&) const {
+    assert(false && "WideBVH::surface: aggregates never own an intersection");
+}
+
+bool WideBVH::occluded(
+    const Ray& r,
+    Real t_min,
+    Real t_max
+) const {
+    if (empty())
+        return false;
+
+    auto leaf = [&](uint32_t first, uint32_t count, Real&) {
+        return primitives.occluded(first, count, r, t_min, t_max);
+    };
+
+    return dispatch_wide<true>(node_width, simd, nodes4, nodes8, r, t_min, t_max, leaf);
+}
+
+uint32_t WideBVH::intersect_packet(
+    const RayPacket& packet,
+    uint32_t active,
+    Intersection* isects
+) const {
+    if (empty() || !active)
+        return 0;
+
+    // одиночному лучу пакетный стек ни к чему
+    if (!(active & (active - 1))) {
+        int k = __builtin_ctz(active);
+        return intersect(packet.rays[k], packet.t_min[k], packet.t_max[k], isects[k]) ? active : 0;
+    }
+
+    Real t_max[RAY_PACKET_MAX];
+    std::copy_n(packet.t_max, packet.count, t_max);
+    auto leaf = [&](int k, uint32_t first, uint32_t count, Real& closest) {
+        return primitives.intersect(first, count, packet.rays[k], packet.t_min[k], closest, isects[k]);
+    };
+
+    return dispatch_wide_packet<false>(node_width, simd, nodes4, nodes8, packet, active, t_max, leaf);
+}
+
+uint32_t WideBVH::occluded_packet(
+    const RayPacket& packet,
+    uint32_t active
+) const {
+    if (empty() || !active)
+        return 0;
+
+    if (!(active & (active - 1))) {
+        int k = __builtin_ctz(active);
+        return occluded(packet.rays[k], packet.t_min[k], packet.t_max[k]) ? active : 0;
+    }
+
+    Real t_max[RAY_PACKET_MAX];
+    std::copy_n(packet.t_max, packet.count, t_max);
+    auto leaf = [&](int k, uint32_t first, uint32_t count, Real& closest) {
+        return primitives.occluded(first, count, packet.rays[k], packet.t_min[k], closest);
+    };
+
+    return dispatch_wide_packet<true>(node_width, simd, nodes4, nodes8, packet, active, t_max, leaf);
+}
+
+bool WideBVH::bounding_box(
+    Real time0,
+    Real time1,
+    AABB& output_box
+) const {
+    if (objects.empty()) return false;
+    output_box = box;
+    return true;
+}
+
+size_t WideBVH::node_count() const {
+    return node_width == 8 ? nodes8.size() : nodes4.size();
+}
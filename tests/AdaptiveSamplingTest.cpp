@@ -0,0 +1,35 @@
+#include "Test.h"
+#include "AdaptiveSampling.h"
+
+namespace {
+    // пиксель постоянной яркости: ошибка нулевая, сходится при первой проверке
+    PixelStats constant_pixel(int samples) {
+        PixelStats stats;
+        for (int i = 0; i < samples; ++i)
+            stats.add(0.5);
+        return stats;
+    }
+}
+
+TEST(adaptive_check_interval) {
+    AdaptiveSettings s;
+    s.enabled        = true;
+    s.min_spp        = 4;
+    s.check_interval = 4;
+    CHECK(!constant_pixel(3).converged(s));    // меньше min_spp
+    CHECK(!constant_pixel(6).converged(s));    // не на границе интервала
+    CHECK(constant_pixel(8).converged(s));
+}
+
+TEST(adaptive_check_interval_below_one) {
+    // 0 и отрицательный интервал — проверка на каждой пробе, без деления на ноль
+    AdaptiveSettings s;
+    s.enabled = true;
+    s.min_spp = 4;
+    for (int interval : { 0, -3 }) {
+        s.check_interval = interval;
+        CHECK(constant_pixel(5).converged(s));
+        CHECK(constant_pixel(7).converged(s));
+        CHECK(!constant_pixel(3).converged(s));
+    }
+}
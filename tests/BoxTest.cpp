@@ -0,0 +1,50 @@
+#include "Test.h"
+#include "Box.h"
+#include "ConstantTexture.h"
+#include "Material.h"
+#include <memory>
+
+namespace {
+    std::shared_ptr<Material> gray() {
+        return std::make_shared<Lambertian>(std::make_shared<ConstantTexture>(Color(0.5, 0.5, 0.5)));
+    }
+}
+
+TEST(box_hit_front_face) {
+    Box box(Point3(-1, -1, -1), Point3(1, 1, 1), gray());
+
+    // снаружи: вход через грань z = 1, нормаль наружу
+    HitRecord rec;
+    CHECK(box.hit(Ray(Point3(0.25, 0.5, 5), Vec3(0, 0, -1)), RAY_T_MIN, REAL_INFINITY, rec));
+    CHECK_NEAR(rec.t, 4.0, 1e-6);
+    CHECK_NEAR(rec.normal.z, 1.0, 1e-6);
+    CHECK(rec.front_face);
+
+    // изнутри: выход через грань x = -1, нормаль против луча
+    CHECK(box.hit(Ray(Point3(0, 0, 0), Vec3(-1, 0, 0)), RAY_T_MIN, REAL_INFINITY, rec));
+    CHECK_NEAR(rec.t, 1.0, 1e-6);
+    CHECK_NEAR(rec.normal.x, 1.0, 1e-6);
+    CHECK(!rec.front_face);
+
+    CHECK(!box.hit(Ray(Point3(3, 0, 5), Vec3(0, 0, -1)), RAY_T_MIN, REAL_INFINITY, rec));
+    CHECK(!box.occluded(Ray(Point3(0, 0, 5), Vec3(0, 0, -1)), RAY_T_MIN, 3.0));
+    CHECK(box.occluded(Ray(Point3(0, 0, 5), Vec3(0, 0, -1)), RAY_T_MIN, 5.0));
+}
+
+TEST(box_hit_does_not_allocate) {
+    auto mat = gray();
+    Box box(Point3(-1, -0.5, -2), Point3(1, 2, 0.5), mat);
+    Box rotated(Point3(-1, -0.5, -2), Point3(1, 2, 0.5), mat, 30, Vec3(1, 1, 0));
+    Ray r(Point3(0, 0, 5), Vec3(0, 0.1, -1));
+
+    HitRecord rec;
+    int hits = 0;
+    std::size_t before = test::allocation_count();
+    for (int i = 0; i < 1000; ++i) {
+        hits += box.hit(r, RAY_T_MIN, REAL_INFINITY, rec);
+        hits += rotated.hit(r, RAY_T_MIN, REAL_INFINITY, rec);
+        hits += box.occluded(r, RAY_T_MIN, REAL_INFINITY);
+    }
+    CHECK(test::allocation_count() == before);
+    CHECK(hits == 3000);
+}
@@ -0,0 +1,112 @@
+#include "Test.h"
+#include "Instance.h"
+#include "TriangleMesh.h"
+#include "Material.h"
+#include "ConstantTexture.h"
+#include "Random.h"
+#include "HittableList.h"
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+    const Transform PLACEMENT = Transform::translate(Vec3(1, 2, -3))
+                              * Transform::rotate(37, Vec3(1, 2, 0.5))
+                              * Transform::scale(Vec3(2, 0.5, 1.5));
+
+    // октаэдр с центром в начале координат
+    const std::vector<Point3> OCTAHEDRON = {
+        Point3(1, 0, 0), Point3(-1, 0, 0), Point3(0, 1, 0),
+        Point3(0, -1, 0), Point3(0, 0, 1), Point3(0, 0, -1),
+    };
+    const std::vector<uint32_t> OCTAHEDRON_FACES = {
+        0, 2, 4,  2, 1, 4,  1, 3, 4,  3, 0, 4,
+        2, 0, 5,  1, 2, 5,  3, 1, 5,  0, 3, 5,
+    };
+
+    std::shared_ptr<Material> white() {
+        return std::make_shared<Lambertian>(std::make_shared<ConstantTexture>(Color(1, 1, 1)));
+    }
+}
+
+TEST(transform_inverse_round_trip) {
+    Transform identity = PLACEMENT * PLACEMENT.inverse();
+    Point3 p = identity.point(Point3(3, 4, 5));
+    CHECK_NEAR(p.x, 3.0, 1e-5);
+    CHECK_NEAR(p.y, 4.0, 1e-5);
+    CHECK_NEAR(p.z, 5.0, 1e-5);
+
+    Point3 q = PLACEMENT.inverse_point(PLACEMENT.point(Point3(-1, 0.5, 2)));
+    CHECK_NEAR(q.x, -1.0, 1e-5);
+    CHECK_NEAR(q.y,  0.5, 1e-5);
+    CHECK_NEAR(q.z,  2.0, 1e-5);
+}
+
+TEST(instance_matches_baked_mesh) {
+    // экземпляр сетки и та же сетка с преобразованием, запечённым в вершины,
+    // должны давать одни и те же попадания
+    auto mat  = white();
+    auto mesh = std::make_shared<TriangleMesh>(OCTAHEDRON, OCTAHEDRON_FACES, mat);
+    Instance instance(mesh, PLACEMENT);
+
+    std::vector<Point3> baked_positions;
+    for (const Point3& p : OCTAHEDRON)
+        baked_positions.push_back(PLACEMENT.point(p));
+    TriangleMesh baked(baked_positions, OCTAHEDRON_FACES, mat);
+
+    Rng rng(5, 6);
+    int hits = 0;
+    for (int k = 0; k < 20000; ++k) {
+        Point3 origin(rng.next_double() * 10 - 4, rng.next_double() * 10 - 3, rng.next_double() * 10 - 8);
+        Point3 target(1 + rng.next_double() - 0.5, 2 + rng.next_double() - 0.5, -3 + rng.next_double() - 0.5);
+        Ray r(origin, target - origin);
+
+        HitRecord a, b;
+        bool hit_instance = instance.hit(r, RAY_T_MIN, REAL_INFINITY, a);
+        bool hit_baked    = baked.hit(r, RAY_T_MIN, REAL_INFINITY, b);
+        CHECK(hit_instance == hit_baked);
+        CHECK(instance.occluded(r, RAY_T_MIN, REAL_INFINITY) == hit_instance);
+        if (!hit_instance || !hit_baked)
+            continue;
+        ++hits;
+        CHECK_NEAR(a.t, b.t, 1e-4);
+        CHECK((a.normal - b.normal).length() < 1e-4);
+        CHECK(a.front_face == b.front_face);
+    }
+    CHECK(hits > 1000);
+}
+
+TEST(instance_bounding_box_covers_geometry) {
+    auto mesh = std::make_shared<TriangleMesh>(OCTAHEDRON, OCTAHEDRON_FACES, white());
+    Instance instance(mesh, PLACEMENT);
+    AABB box;
+    CHECK(instance.bounding_box(0, 1, box));
+    for (const Point3& p : OCTAHEDRON) {
+        Point3 w = PLACEMENT.point(p);
+        for (int a = 0; a < 3; ++a)
+            CHECK(box.minimum[a] <= w[a] && w[a] <= box.maximum[a]);
+    }
+}
+
+TEST(instance_nesting_limit) {
+    // MAX_INSTANCE_DEPTH уровней работают, ещё один отвергается при создании
+    HittablePtr object = std::make_shared<TriangleMesh>(OCTAHEDRON, OCTAHEDRON_FACES, white());
+    for (int level = 0; level < MAX_INSTANCE_DEPTH; ++level)
+        object = std::make_shared<Instance>(object, Transform::translate(Vec3(0, 0, -1)));
+    CHECK(object->instance_nesting() == MAX_INSTANCE_DEPTH);
+
+    HitRecord rec;
+    Ray r(Point3(0, 0, 5), Vec3(0, 0, -1));
+    CHECK(object->hit(r, RAY_T_MIN, REAL_INFINITY, rec));
+    CHECK_NEAR(rec.t, 5.0 + MAX_INSTANCE_DEPTH - 1.0, 1e-5);
+
+    // вложенность видна и сквозь агрегаты
+    HittableList list(object);
+    bool rejected = false;
+    try {
+        Instance too_deep(std::make_shared<HittableList>(list), Transform::translate(Vec3(1, 0, 0)));
+    } catch (const std::invalid_argument&) {
+        rejected = true;
+    }
+    CHECK(rejected);
+}
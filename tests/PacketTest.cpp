@@ -0,0 +1,83 @@
+#include "Test.h"
+#include "WideBVH.h"
+#include "ParallelBVH.h"
+#include "Sphere.h"
+#include "XYRect.h"
+#include "Box.h"
+#include "Material.h"
+#include "ConstantTexture.h"
+#include "Random.h"
+#include <memory>
+#include <vector>
+
+namespace {
+    // сферы (пачками для пакетного ядра), прямоугольники и коробки вперемешку
+    std::vector<HittablePtr> random_scene(int count) {
+        auto mat = std::make_shared<Lambertian>(std::make_shared<ConstantTexture>(Color(0.5, 0.5, 0.5)));
+        std::vector<HittablePtr> objects;
+        Rng rng(7, 1);
+        for (int i = 0; i < count; ++i) {
+            Point3 c(rng.next_double() * 100 - 50, rng.next_double() * 100 - 50, rng.next_double() * 100 - 50);
+            if (i % 10 < 8)
+                objects.push_back(std::make_shared<Sphere>(c, 0.2 + 0.3 * rng.next_double(), mat));
+            else if (i % 10 == 8)
+                objects.push_back(std::make_shared<XYRect>(c.x, c.x + 0.5, c.y, c.y + 0.5, c.z, mat));
+            else
+                objects.push_back(std::make_shared<Box>(c, c + Vec3(0.4, 0.4, 0.4), mat));
+        }
+        return objects;
+    }
+
+    // пучок почти параллельных лучей, часть — с коротким t_max
+    RayPacket random_packet(Rng& rng, int count) {
+        RayPacket packet;
+        Point3 origin(rng.next_double() * 100 - 50, rng.next_double() * 100 - 50, -60);
+        Vec3   base(rng.next_double() - 0.5, rng.next_double() - 0.5, 1);
+        for (int k = 0; k < count; ++k) {
+            Vec3 d = base + Vec3((k % 4) * 0.0004, (k / 4) * 0.0004, 0);
+            packet.add(Ray(origin, d), RAY_T_MIN, k % 3 == 0 ? Real(50) : REAL_INFINITY);
+        }
+        return packet;
+    }
+}
+
+TEST(packet_matches_single_rays) {
+    // пакетный обход должен давать ровно те же попадания, что и по одному лучу
+    std::vector<HittablePtr> objects = random_scene(20000);
+    ParallelBVHOptions options;
+    options.leaf_batch_size = 4;
+    for (int width : { 4, 8 }) {
+        WideBVH bvh(objects, 0, 1, options, width);
+        Rng rng(11, uint64_t(width));
+        int hits = 0;
+        for (int p = 0; p < 4000; ++p) {
+            RayPacket packet = random_packet(rng, 1 + p % RAY_PACKET_MAX);
+
+            Intersection packet_isect[RAY_PACKET_MAX], single_isect[RAY_PACKET_MAX];
+            uint32_t found = bvh.intersect_packet(packet, packet.all(), packet_isect);
+            uint32_t expected_found = 0, expected_occluded = 0;
+            for (int k = 0; k < packet.count; ++k) {
+                const Ray& r = packet.rays[k];
+                if (bvh.intersect(r, packet.t_min[k], packet.t_max[k], single_isect[k]))
+                    expected_found |= 1u << k;
+                if (bvh.occluded(r, packet.t_min[k], packet.t_max[k]))
+                    expected_occluded |= 1u << k;
+            }
+            CHECK(found == expected_found);
+            for (int k = 0; k < packet.count; ++k) {
+                if (!((found >> k) & 1))
+                    continue;
+                CHECK(packet_isect[k].t == single_isect[k].t);
+                CHECK(packet_isect[k].object == single_isect[k].object);
+                CHECK(packet_isect[k].prim == single_isect[k].prim);
+            }
+            hits += __builtin_popcount(found);
+
+            CHECK(bvh.occluded_packet(packet, packet.all()) == expected_occluded);
+            // неактивные лучи не проверяются и в результат не попадают
+            uint32_t subset = packet.all() & 0x5555u;
+            CHECK(bvh.occluded_packet(packet, subset) == (expected_occluded & subset));
+        }
+        CHECK(hits > 0);
+    }
+}
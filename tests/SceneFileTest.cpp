@@ -0,0 +1,121 @@
+#include "Test.h"
+#include "SceneFile.h"
+#include "ParallelBVH.h"
+#include "WideBVH.h"
+#include "Sphere.h"
+#include "Material.h"
+#include "ConstantTexture.h"
+#include "Random.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+    // смещения полей заголовка .rtsc (SceneFile.cpp)
+    constexpr size_t NODE_COUNT_FIELD  = 20;
+    constexpr size_t NODE_OFFSET_FIELD = 48;
+
+    std::string temp_path(const char* name) {
+        return (fs::temp_directory_path() / name).string();
+    }
+
+    // записать сцену из count сфер и вернуть байты файла
+    std::vector<char> saved_scene(const std::string& path, int count) {
+        auto mat = std::make_shared<Lambertian>(std::make_shared<ConstantTexture>(Color(0.5, 0.5, 0.5)));
+        HittableList world;
+        Rng rng(3, 4);
+        for (int i = 0; i < count; ++i)
+            world.add(std::make_shared<Sphere>(
+                Point3(rng.next_double() * 20 - 10, rng.next_double() * 20 - 10, rng.next_double() * 20 - 10),
+                0.3, mat));
+        std::string error;
+        CHECK(write_scene_file(path, world, ParallelBVHOptions(), error));
+        std::ifstream in(path, std::ios::binary);
+        return std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    bool load_bytes(const std::string& path, const std::vector<char>& bytes) {
+        {
+            std::ofstream out(path, std::ios::binary);
+            out.write(bytes.data(), std::streamsize(bytes.size()));
+        }
+        LoadedScene scene;
+        std::string error;
+        return load_scene_file(path, scene, error);
+    }
+
+    template <typename T>
+    T field(const std::vector<char>& bytes, size_t offset) {
+        T value;
+        std::memcpy(&value, bytes.data() + offset, sizeof(T));
+        return value;
+    }
+
+    template <typename T>
+    void set_field(std::vector<char>& bytes, size_t offset, T value) {
+        std::memcpy(bytes.data() + offset, &value, sizeof(T));
+    }
+}
+
+TEST(scene_file_round_trip) {
+    const std::string path = temp_path("rt_test_scene.rtsc");
+    std::vector<char> bytes = saved_scene(path, 40);
+
+    LoadedScene scene;
+    std::string error;
+    CHECK(load_scene_file(path, scene, error));
+    CHECK(scene.objects.size() == 40);
+    CHECK(scene.bvh_nodes.size() > 1);
+    CHECK(scene.bvh_order.size() == 40);
+    fs::remove(path);
+}
+
+TEST(scene_file_rejects_bad_bvh) {
+    const std::string path = temp_path("rt_test_scene_bad.rtsc");
+    const std::vector<char> good = saved_scene(path, 40);
+    const uint64_t node_offset = field<uint64_t>(good, NODE_OFFSET_FIELD);
+
+    // примитивы без дерева
+    std::vector<char> no_nodes = good;
+    set_field<uint32_t>(no_nodes, NODE_COUNT_FIELD, 0);
+    CHECK(!load_bytes(path, no_nodes));
+
+    // корень — лист с одним примитивом: остальные не покрыты
+    std::vector<char> partial = good;
+    set_field<uint32_t>(partial, node_offset + 24, 0);
+    set_field<uint32_t>(partial, node_offset + 28, 1);
+    CHECK(!load_bytes(path, partial));
+
+    // ребёнок ссылается на корень — цикл
+    std::vector<char> cycle = good;
+    set_field<uint32_t>(cycle, node_offset + 24, 0);
+    CHECK(!load_bytes(path, cycle));
+
+    CHECK(load_bytes(path, good));
+    fs::remove(path);
+}
+
+TEST(wide_bvh_without_nodes_is_empty) {
+    // пустое дерево над непустой сценой не обходится
+    auto mat = std::make_shared<Lambertian>(std::make_shared<ConstantTexture>(Color(0.5, 0.5, 0.5)));
+    std::vector<HittablePtr> objects = { std::make_shared<Sphere>(Point3(0, 0, -2), 0.5, mat) };
+    WideBVH bvh(objects, std::vector<LinearBVHNode>(), std::vector<uint32_t>(), 4);
+
+    Ray r(Point3(0, 0, 0), Vec3(0, 0, -1));
+    Intersection isect;
+    CHECK(!bvh.intersect(r, RAY_T_MIN, REAL_INFINITY, isect));
+    CHECK(!bvh.occluded(r, RAY_T_MIN, REAL_INFINITY));
+
+    RayPacket packet;
+    packet.add(r, RAY_T_MIN, REAL_INFINITY);
+    packet.add(r, RAY_T_MIN, REAL_INFINITY);
+    Intersection isects[RAY_PACKET_MAX];
+    CHECK(bvh.intersect_packet(packet, packet.all(), isects) == 0);
+    CHECK(bvh.occluded_packet(packet, packet.all()) == 0);
+}
@@ -0,0 +1,31 @@
+// Минимальный набор тестов без внешних зависимостей: TEST(имя) регистрирует
+// функцию, CHECK отмечает провал и продолжает тест, run_tests (TestMain.cpp)
+// запускает всё и возвращает ненулевой код, если что-то упало.
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+namespace test {
+    using TestFunction = void (*)();
+
+    // добавить тест в общий список; вызывается из статического инициализатора
+    bool register_test(const char* name, TestFunction fn);
+
+    void report_failure(const char* file, int line, const char* expr);
+
+    // число вызовов глобального operator new с начала программы
+    std::size_t allocation_count();
+}
+
+#define TEST(name)                                                          \
+    static void name();                                                     \
+    static const bool name##_registered = test::register_test(#name, name); \
+    static void name()
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if (!(cond)) test::report_failure(__FILE__, __LINE__, #cond);       \
+    } while (0)
+
+#define CHECK_NEAR(a, b, eps) CHECK(std::fabs((a) - (b)) <= (eps))
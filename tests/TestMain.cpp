@@ -0,0 +1,64 @@
+#include "Test.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+namespace {
+    struct TestCase {
+        const char*        name;
+        test::TestFunction fn;
+    };
+
+    // список в функции: порядок инициализации статиков между файлами не задан
+    std::vector<TestCase>& registry() {
+        static std::vector<TestCase> tests;
+        return tests;
+    }
+
+    int                      failures = 0;
+    std::atomic<std::size_t> allocations{ 0 };
+}
+
+// Глобальный operator new со счётчиком: тесты сравнивают allocation_count()
+// до и после кода, который не должен выделять память. new[] и nothrow-формы
+// по умолчанию идут через эту функцию.
+void* operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace test {
+    bool register_test(const char* name, TestFunction fn) {
+        registry().push_back({ name, fn });
+        return true;
+    }
+
+    void report_failure(const char* file, int line, const char* expr) {
+        std::fprintf(stderr, "  %s:%d: CHECK(%s) failed\n", file, line, expr);
+        ++failures;
+    }
+
+    std::size_t allocation_count() {
+        return allocations.load(std::memory_order_relaxed);
+    }
+}
+
+int main() {
+    int failed_tests = 0;
+    for (const TestCase& t : registry()) {
+        int before = failures;
+        t.fn();
+        bool ok = failures == before;
+        std::printf("[%s] %s\n", ok ? "  OK  " : "FAILED", t.name);
+        if (!ok) ++failed_tests;
+    }
+    std::printf("%zu tests, %d failed\n", registry().size(), failed_tests);
+    return failed_tests == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,111 @@
+#include "Test.h"
+#include "Vec3.h"
+#include <cstdint>
+#include <type_traits>
+
+namespace {
+    bool equal(const Vec3& a, const Vec3& b) {
+        return a.x == b.x && a.y == b.y && a.z == b.z;
+    }
+}
+
+TEST(vec3_arithmetic) {
+    Vec3 a(1, 2, 3), b(4, -5, 6);
+    CHECK(equal(a + b, Vec3(5, -3, 9)));
+    CHECK(equal(a - b, Vec3(-3, 7, -3)));
+    CHECK(equal(a * b, Vec3(4, -10, 18)));
+    CHECK(equal(2 * a, Vec3(2, 4, 6)));
+    CHECK(equal(a * 2, Vec3(2, 4, 6)));
+    CHECK(equal(b / 2, Vec3(2, -2.5, 3)));
+    CHECK(equal(-a, Vec3(-1, -2, -3)));
+    CHECK(dot(a, b) == 12);
+    CHECK(a.length_squared() == 14);
+
+    Vec3 c = a;
+    c += b;
+    CHECK(equal(c, Vec3(5, -3, 9)));
+    c *= 2;
+    CHECK(equal(c, Vec3(10, -6, 18)));
+    c /= 4;
+    CHECK(equal(c, Vec3(2.5, -1.5, 4.5)));
+}
+
+TEST(vec3_cross) {
+    Vec3 x(1, 0, 0), y(0, 1, 0), z(0, 0, 1);
+    CHECK(equal(cross(x, y), z));
+    CHECK(equal(cross(y, z), x));
+    CHECK(equal(cross(z, x), y));
+    CHECK(equal(cross(y, x), -z));
+
+    // перпендикулярен обоим множителям
+    Vec3 a(1, 2, 3), b(4, -5, 6);
+    Vec3 c = cross(a, b);
+    CHECK(equal(c, Vec3(27, 6, -13)));
+    CHECK(dot(c, a) == 0);
+    CHECK(dot(c, b) == 0);
+}
+
+TEST(vec3_unit_vector) {
+    Vec3 u = unit_vector(Vec3(3, 0, -4));
+    CHECK_NEAR(u.length(), 1.0, 1e-6);
+    CHECK_NEAR(u.x,  0.6, 1e-6);
+    CHECK_NEAR(u.z, -0.8, 1e-6);
+    CHECK(u.y == 0);
+    CHECK(max_abs_component(Vec3(1, -7, 3)) == 7);
+}
+
+TEST(vec3_index) {
+    Vec3 v(7, 8, 9);
+    CHECK(v[0] == 7 && v[1] == 8 && v[2] == 9);
+    v[1] = -1;
+    CHECK(v.y == -1);
+    for (int a = 0; a < 3; ++a)
+        v[a] += 1;
+    CHECK(equal(v, Vec3(8, 0, 10)));
+
+    const Vec3 c(1, 2, 3);
+    CHECK(c[2] == 3);
+    static_assert(Vec3(4, 5, 6)[2] == 6, "operator[] must be constexpr");
+}
+
+TEST(vec3_random_range) {
+    // наибольшее значение next_u32: через double во float округлилось бы до 1
+    CHECK(float(0xFFFFFFFFu * (1.0 / 4294967296.0)) == 1.0f);
+    CHECK((0xFFFFFFFFu >> 8) * 0x1p-24f < 1.0f);
+
+    for (int i = 0; i < 10000; ++i) {
+        Vec3 v = Vec3::random();
+        Vec3 w = Vec3::random(-2, 3);
+        for (int a = 0; a < 3; ++a) {
+            CHECK(v[a] >= 0 && v[a] < 1);
+            CHECK(w[a] >= -2 && w[a] < 3);
+        }
+    }
+}
+
+#ifdef RT_VEC3_SIMD4
+TEST(vec3_simd4_layout) {
+    static_assert(sizeof(Vec3) == 4 * sizeof(Real), "Vec3 must fill one 4-lane register");
+    static_assert(alignof(Vec3) == 4 * sizeof(Real), "Vec3 must be aligned to 4 lanes");
+    static_assert(std::is_trivially_copyable<Vec3>::value, "Vec3 must stay trivially copyable");
+
+    // дорожка w остаётся нулём после любых операций
+    Vec3 a(1, 2, 3), b(4, -5, 6);
+    Vec3 results[] = {
+        a + b, a - b, a * b, 2 * a, a * 2, a / 2, -a,
+        cross(a, b), unit_vector(a), Vec3(), Vec3::random(),
+    };
+    for (const Vec3& r : results)
+        CHECK(r.w == 0);
+
+    Vec3 c = a;
+    c += b;
+    c *= 3;
+    c /= 2;
+    c[1] = 5;
+    CHECK(c.w == 0);
+
+    Vec3 array[3];
+    CHECK(reinterpret_cast<uintptr_t>(&array[1]) % alignof(Vec3) == 0);
+}
+#endif
@@ -0,0 +1,105 @@
+#include "Test.h"
+#include "Wavefront.h"
+#include "Integrator.h"
+#include "Sampler.h"
+#include "WideBVH.h"
+#include "ParallelBVH.h"
+#include "Sphere.h"
+#include "XZRect.h"
+#include "Box.h"
+#include "Material.h"
+#include "ConstantTexture.h"
+#include <memory>
+#include <vector>
+
+namespace {
+    // все известные типы материалов плюс наследник (тип Other)
+    class TintedLambertian : public Lambertian {
+    public:
+        using Lambertian::Lambertian;
+    };
+
+    std::vector<HittablePtr> material_scene() {
+        auto gray  = std::make_shared<ConstantTexture>(Color(0.6, 0.6, 0.6));
+        auto light = std::make_shared<ConstantTexture>(Color(4, 4, 4));
+        std::vector<HittablePtr> objects;
+        objects.push_back(std::make_shared<XZRect>(-10, 10, -10, 10, 0.0, std::make_shared<Lambertian>(gray)));
+        objects.push_back(std::make_shared<Sphere>(Point3(-1.5, 0.5, -2), 0.5, std::make_shared<Metal>(Color(0.8, 0.8, 0.8), 0.1)));
+        objects.push_back(std::make_shared<Sphere>(Point3(0, 0.5, -2), 0.5, std::make_shared<Dielectric>(1.5)));
+        objects.push_back(std::make_shared<Sphere>(Point3(1.5, 0.5, -2), 0.5, std::make_shared<TintedLambertian>(gray)));
+        objects.push_back(std::make_shared<Box>(Point3(-0.5, 2, -3), Point3(0.5, 2.2, -2), std::make_shared<DiffuseLight>(light)));
+        return objects;
+    }
+}
+
+TEST(wavefront_matches_path) {
+    // каждый путь берёт пробы из своего Sampler::State, поэтому волновой
+    // интегратор обязан совпасть с path_color бит в бит
+    std::vector<HittablePtr> objects = material_scene();
+    WideBVH world(objects, 0, 1, ParallelBVHOptions());
+
+    for (AOMode mode : { AOMode::FirstDiffuse, AOMode::EveryBounce }) {
+        IntegratorSettings settings;
+        settings.type      = IntegratorType::Path;
+        settings.max_depth = 8;
+        settings.ao.samples = 4;
+        settings.ao_mode   = mode;
+
+        const int spp = 4;
+        std::unique_ptr<Sampler> sampler = make_sampler(SamplerType::Sobol, spp, 0);
+        thread_sampler() = sampler.get();
+
+        const int size = 16;
+        std::vector<Ray>            rays;
+        std::vector<Sampler::State> states;
+        for (int j = 0; j < size; ++j) {
+            for (int i = 0; i < size; ++i) {
+                for (int s = 0; s < spp; ++s) {
+                    sampler->start_pixel_sample(uint64_t(j) * size + i, s);
+                    Sample2D jitter = sampler->get_2d();
+                    Vec3 dir((i + jitter.x) / size * 4 - 2, 1 - (j + jitter.y) / size * 2, -1);
+                    rays.push_back(Ray(Point3(0, 1, 1), dir));
+                    states.push_back(sampler->save_state());
+                }
+            }
+        }
+
+        const int count = int(rays.size());
+        std::vector<Color> expected(count), colors(count);
+        for (int k = 0; k < count; ++k) {
+            sampler->restore_state(states[k]);
+            expected[k] = path_color(rays[k], world, settings);
+        }
+
+        // по одному лучу и пакетами (основные и AO-лучи)
+        for (int packet_size : { 1, RAY_PACKET_MAX }) {
+            IntegratorSettings wave_settings = settings;
+            wave_settings.ao.packet_size = packet_size;
+            WavefrontIntegrator wavefront(world, wave_settings, packet_size);
+            wavefront.trace(rays.data(), states.data(), count, *sampler, colors.data());
+
+            int nonzero = 0;
+            for (int k = 0; k < count; ++k) {
+                CHECK(colors[k].x == expected[k].x && colors[k].y == expected[k].y && colors[k].z == expected[k].z);
+                nonzero += expected[k].length_squared() > 0;
+            }
+            CHECK(nonzero > count / 2);
+        }
+        thread_sampler() = nullptr;
+    }
+}
+
+TEST(material_kind_exact_type) {
+    auto tex = std::make_shared<ConstantTexture>(Color(1, 1, 1));
+    Lambertian       lambertian(tex);
+    TintedLambertian derived(tex);
+    Metal            metal(Color(1, 1, 1), 0);
+    Dielectric       glass(1.5);
+    DiffuseLight     light(tex);
+    CHECK(material_kind(&lambertian) == MaterialKind::Lambertian);
+    CHECK(material_kind(&metal) == MaterialKind::Metal);
+    CHECK(material_kind(&glass) == MaterialKind::Dielectric);
+    CHECK(material_kind(&light) == MaterialKind::DiffuseLight);
+    // наследник может переопределить scatter — только виртуальный вызов
+    CHECK(material_kind(&derived) == MaterialKind::Other);
+}